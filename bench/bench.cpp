@@ -0,0 +1,283 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <filesystem>
+#include "ObjectData.hpp"
+#include "JobSystem.hpp"
+#include "generators.hpp"
+
+#define BENCH_OBJ_PATH "/tmp/scop_bench.obj"
+#define BENCH_SPHERE_RINGS 600 // About 720k triangles
+#define BENCH_REPEATS 3 // Best of, to keep scheduler noise out of the scaling
+#define BENCH_RAYS (1 << 20)
+#define BENCH_SUITE_DIR "/tmp"
+#define BENCH_SUITE_REPEATS 5 // Best and median of, the median is what to track
+#define BENCH_GRID_SIZE 500 // Quads per side at scale 1, 500k triangles
+#define BENCH_ICOSPHERE_LEVELS 7 // 328k triangles
+#define BENCH_POLYGON_COUNT 20000 // At scale 1, 280k triangles
+#define BENCH_POLYGON_SIDES 16
+#define BENCH_TEXTURE_SIZE 2048
+#define BENCH_MATRIX_OPS 1000000
+#define BENCH_USAGE "USAGE: ./scop_bench [--scale S] [--repeats N] [--json]\n       ./scop_bench --scaling [file.obj [threads]]"
+
+std::atomic<errorType> errorCode = NO_ERROR;
+
+struct SuiteOptions {
+	double scale = 1.0; // Of every generated model and the texture
+	int repeats = BENCH_SUITE_REPEATS;
+	bool json = false; // One JSON object per line instead of the table, for regression tracking
+};
+
+// reset runs before every repeat and is not timed.
+template <typename Function, typename Reset>
+static double bestOf(Function&& function, Reset&& reset) {
+	double best = INFINITY;
+	for (int i = 0; i < BENCH_REPEATS; ++i) {
+		reset();
+		const auto start = std::chrono::steady_clock::now();
+		function();
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	return best;
+}
+
+template <typename Function>
+static double bestOf(Function&& function) {
+	return bestOf(std::forward<Function>(function), [] {});
+}
+
+// Rays from a shell around the model aimed inside its inner half, the same set for every run.
+static void generateRays(const float radius, std::vector<Vec3>& origins, std::vector<Vec3>& directions) {
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	const auto inBall = [&] {
+		Vec3 p;
+		do
+			p = Vec3(unit(random), unit(random), unit(random));
+		while (Vec3::dot(p, p) > 1.0f);
+		return p;
+	};
+	for (size_t i = 0; i < origins.size(); ++i) {
+		origins[i] = Vec3::normalize(inBall()) * (radius * 3.0f);
+		directions[i] = inBall() * (radius * 0.5f) - origins[i];
+	}
+}
+
+// Thread scaling of the load stages on one model, from 1 to maxThreads threads.
+static void runScaling(const char* path, const size_t maxThreads) {
+	JobSystem& jobs = JobSystem::getInstance();
+	ObjectData object;
+	if (path == nullptr) {
+		path = BENCH_OBJ_PATH;
+		std::cout << "Generating " << path << "..." << std::endl;
+		generateSphere(path, BENCH_SPHERE_RINGS);
+	}
+	std::cout << BOLD << "threads    load ms  speedup  normals ms  Mcorners/s  speedup  texture ms  speedup  bvh ms  speedup  Mrays/s  speedup     steals" << RESET << std::endl;
+	double baseLoad = 0.0, baseNormals = 0.0, baseTexture = 0.0, baseBvh = 0.0, baseRays = 0.0;
+	std::vector<Vec3> origins(BENCH_RAYS), directions(BENCH_RAYS);
+	for (size_t threads = 1; threads <= maxThreads; ++threads) {
+		jobs.setThreadCount(threads);
+		const size_t steals = jobs.getSteals();
+		std::streambuf* console = std::cout.rdbuf(nullptr); // The loader reports every run
+		const double load = bestOf([&] { object.load(path); }, [&] { object.unload(); });
+		const Bvh& bvh = object.getBvh(); // Built by the last load, before anything else is timed
+		const NormalStats normals = object.getNormalStats(); // Of the last load, every load computes the same normals
+		const double texture = bestOf([&] { object.decodePPM(TEX_PATH); });
+		std::cout.rdbuf(console);
+		std::cout.clear();
+		if (threads == 1) {
+			const BvhNode& root = bvh.getRoot();
+			generateRays((root.max - root.min).length() * 0.5f, origins, directions);
+		}
+		std::atomic<size_t> hits = 0;
+		const double rays = BENCH_RAYS / bestOf([&] {
+			parallelFor(BENCH_RAYS, 4096, [&](const size_t begin, const size_t end, size_t) {
+				size_t found = 0;
+				for (size_t i = begin; i < end; ++i) {
+					RayHit hit;
+					found += bvh.intersect(origins[i], directions[i], hit);
+				}
+				hits += found;
+			});
+		}) / 1000.0;
+		if (threads == 1) {
+			baseLoad = load;
+			baseNormals = normals.ms;
+			baseTexture = texture;
+			baseBvh = bvh.getBuildMs();
+			baseRays = rays;
+		}
+		std::cout << std::fixed << std::setprecision(2) << std::setw(7) << threads << std::setw(11) << load
+			<< std::setw(8) << baseLoad / load << "x" << std::setw(12) << normals.ms
+			<< std::setw(12) << static_cast<double>(normals.fileCorners + normals.generatedCorners) / normals.ms / 1000.0
+			<< std::setw(8) << baseNormals / normals.ms << "x" << std::setw(12) << texture << std::setw(8) << baseTexture / texture << "x"
+			<< std::setw(8) << bvh.getBuildMs() << std::setw(8) << baseBvh / bvh.getBuildMs() << "x"
+			<< std::setw(9) << rays << std::setw(8) << rays / baseRays << "x"
+			<< std::setw(11) << jobs.getSteals() - steals << std::endl;
+	}
+}
+
+struct Timing {
+	double best = INFINITY;
+	double median = 0.0;
+};
+
+// sample runs once per repeat and returns the milliseconds it took, reset runs before it.
+template <typename Sample, typename Reset>
+static Timing measure(const int repeats, Sample&& sample, Reset&& reset) {
+	std::vector<double> times;
+	for (int i = 0; i < repeats; ++i) {
+		reset();
+		times.push_back(sample());
+	}
+	std::sort(times.begin(), times.end());
+	return {times.front(), times[times.size() / 2]};
+}
+
+template <typename Function>
+static double timed(Function&& function) {
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// One row per benchmark. The throughput is of the median run, work is in unit per run.
+static void report(const SuiteOptions& options, const std::string& name, const std::string& size, const Timing& timing,
+	const double work, const char* unit) {
+	const double throughput = work / (timing.median / 1000.0);
+	if (options.json) {
+		std::cout << std::fixed << std::setprecision(3) << "{\"benchmark\":\"" << name << "\",\"size\":\"" << size
+			<< "\",\"best_ms\":" << timing.best << ",\"median_ms\":" << timing.median << ",\"throughput\":" << throughput
+			<< ",\"unit\":\"" << unit << "/s\"}" << std::endl;
+		return;
+	}
+	std::cout << std::left << std::setw(22) << name << std::setw(18) << size << std::right << std::fixed << std::setprecision(2)
+		<< std::setw(11) << timing.best << std::setw(11) << timing.median << std::setw(12) << throughput << " " << unit << "/s" << std::endl;
+}
+
+static std::string describe(const double value, const char* unit) {
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(value < 10.0 ? 2 : 1) << value << " " << unit;
+	return out.str();
+}
+
+// Generation, load and attribute packing of one synthetic model. Loads run headless, so neither
+// the console nor a BVH build is part of the timing.
+template <typename Generate>
+static void benchModel(const SuiteOptions& options, const std::string& name, Generate&& generate) {
+	const std::string path = std::string(BENCH_SUITE_DIR) + "/scop_bench_" + name + ".obj";
+	const Timing generation = measure(1, [&] { return timed([&] { generate(path); }); }, [] {});
+	const double megabytes = static_cast<double>(std::filesystem::file_size(path)) / (1 << 20);
+	report(options, "generate/" + name, describe(megabytes, "MB"), generation, megabytes, "MB");
+	ObjectData object;
+	object.setHeadless(true);
+	object.setDiagnosticsMode(false, true);
+	std::vector<double> attributes;
+	const Timing load = measure(options.repeats, [&] {
+		const double ms = timed([&] { object.load(path.c_str()); });
+		attributes.push_back(object.getLoadStats().attributesMs);
+		return ms;
+	}, [&] { object.unload(); });
+	const double triangles = static_cast<double>(object.getTriangleCount()) / 1e6;
+	report(options, "load/" + name, describe(megabytes, "MB"), load, megabytes, "MB");
+	std::sort(attributes.begin(), attributes.end());
+	report(options, "attributes/" + name, describe(triangles, "Mtris"), {attributes.front(), attributes[attributes.size() / 2]},
+		triangles * 3.0, "Mcorners");
+	object.unload();
+	std::filesystem::remove(path);
+}
+
+// Mat4 products and the camera matrices the render loop builds every frame. Each result feeds
+// the next one or a sink, so none of it can be optimised away.
+static void benchMatrices(const SuiteOptions& options) {
+	const size_t count = BENCH_MATRIX_OPS;
+	const std::string size = describe(static_cast<double>(count) / 1e6, "Mops");
+	volatile float sink = 0.0f;
+	const Mat4 step = Mat4::rotateY(0.001f) * Mat4::translate(Vec3(0.0f, 0.0f, 1e-6f));
+	report(options, "mat4/multiply", size, measure(options.repeats, [&] {
+		return timed([&] {
+			Mat4 product = Mat4::identity();
+			for (size_t i = 0; i < count; ++i)
+				product = product * step;
+			sink = sink + product.data()[0];
+		});
+	}, [] {}), static_cast<double>(count) / 1e6, "Mops");
+	report(options, "mat4/camera", size, measure(options.repeats, [&] {
+		return timed([&] {
+			float total = 0.0f;
+			for (size_t i = 0; i < count; ++i) {
+				const float t = static_cast<float>(i) * 1e-4f;
+				const Mat4 view = Mat4::lookAt(Vec3(std::cos(t) * 5.0f, 1.0f, std::sin(t) * 5.0f), Vec3(), Vec3(0.0f, 1.0f, 0.0f));
+				total += (Mat4::perspective(60.0f + t, 1.5f, 0.1f, 100.0f) * view).data()[5];
+			}
+			sink = sink + total;
+		});
+	}, [] {}), static_cast<double>(count) / 1e6, "Mops");
+}
+
+// Model sizes grow with scale, triangle counts roughly linearly. Nothing is random, so two runs at
+// the same scale do the same work.
+static void runSuite(const SuiteOptions& options) {
+	const double scale = options.scale;
+	const int grid = std::max(1, static_cast<int>(std::lround(BENCH_GRID_SIZE * std::sqrt(scale))));
+	const int levels = std::max(0, BENCH_ICOSPHERE_LEVELS + static_cast<int>(std::lround(std::log(scale) / std::log(4.0))));
+	const int polygons = std::max(1, static_cast<int>(std::lround(BENCH_POLYGON_COUNT * scale)));
+	const int texture = std::max(1, static_cast<int>(std::lround(BENCH_TEXTURE_SIZE * std::sqrt(scale))));
+	if (!options.json) {
+		std::cout << BOLD << "scop benchmark suite: scale " << scale << ", " << JobSystem::getInstance().getThreadCount() << " threads, "
+			<< options.repeats << " repeats" << RESET << std::endl;
+		std::cout << BOLD << std::left << std::setw(22) << "benchmark" << std::setw(18) << "size" << std::right << std::setw(11) << "best ms"
+			<< std::setw(11) << "median ms" << std::setw(12) << "throughput" << RESET << std::endl;
+	}
+	benchModel(options, "grid", [grid](const std::string& path) { generateGrid(path, grid); });
+	benchModel(options, "icosphere", [levels](const std::string& path) { generateIcosphere(path, levels); });
+	benchModel(options, "polygons", [polygons](const std::string& path) { generatePolygons(path, polygons, BENCH_POLYGON_SIDES); });
+
+	const std::string ppm = std::string(BENCH_SUITE_DIR) + "/scop_bench_texture.ppm";
+	generatePPM(ppm, texture, texture);
+	const double megabytes = static_cast<double>(texture) * texture * 3.0 / (1 << 20);
+	ObjectData object;
+	report(options, "ppm/decode", std::to_string(texture) + "x" + std::to_string(texture), measure(options.repeats, [&] {
+		return timed([&] { object.decodePPM(ppm.c_str()); });
+	}, [] {}), megabytes, "MB");
+	std::filesystem::remove(ppm);
+	benchMatrices(options);
+}
+
+int main(const int argc, const char* argv[]) {
+	StartupTimeline::getInstance().stop(); // Loads repeat and nothing prints it
+	try {
+		SuiteOptions options;
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg(argv[i]);
+			if (arg == "--scaling") {
+				runScaling(i + 1 < argc ? argv[i + 1] : nullptr,
+					i + 2 < argc ? std::stoul(argv[i + 2]) : std::max(1u, std::thread::hardware_concurrency()));
+				return errorCode;
+			}
+			if (arg == "--json")
+				options.json = true;
+			else if (arg == "--scale" && i + 1 < argc)
+				options.scale = std::stod(argv[++i]);
+			else if (arg == "--repeats" && i + 1 < argc)
+				options.repeats = std::max(1, std::stoi(argv[++i]));
+			else
+				throw RuntimeException("ERROR: Invalid option \"" + arg + "\"\n" BENCH_USAGE);
+		}
+		if (!(options.scale > 0.0))
+			throw RuntimeException("ERROR: Invalid option \"--scale\"\n" BENCH_USAGE);
+		runSuite(options);
+	}
+	catch (const std::exception& e) {
+		std::cerr << RED << e.what() << RESET << std::endl;
+		errorCode = errorCode == NO_ERROR ? UNDEFINED_ERROR : errorCode.load();
+	}
+	return errorCode;
+}
@@ -0,0 +1,142 @@
+#ifndef GENERATORS_HPP
+#define GENERATORS_HPP
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <iomanip>
+#include "matrix.hpp"
+#include "exceptionTypes.hpp"
+
+// Synthetic models for the benchmark suite. Every generator is deterministic and prints with a
+// fixed precision, so a given size always produces the same bytes and timings stay comparable.
+
+inline std::ofstream openOutput(const std::string& path) {
+	std::ofstream file(path);
+	if (!file.is_open())
+		throw RuntimeException("ERROR: Unable to write " + path);
+	file << std::fixed << std::setprecision(6);
+	return file;
+}
+
+// UV sphere written as quads, so the parser also exercises fan triangulation.
+inline void generateSphere(const std::string& path, const int rings) {
+	std::ofstream file = openOutput(path);
+	const int segments = rings * 2;
+	for (int i = 0; i <= rings; ++i) {
+		const double theta = M_PI * i / rings;
+		for (int j = 0; j < segments; ++j) {
+			const double phi = 2.0 * M_PI * j / segments;
+			file << "v " << std::sin(theta) * std::cos(phi) << " " << std::cos(theta) << " " << std::sin(theta) * std::sin(phi) << "\n";
+		}
+	}
+	for (int i = 0; i < rings; ++i) {
+		for (int j = 0; j < segments; ++j) {
+			const int a = i * segments + j + 1;
+			const int b = i * segments + (j + 1) % segments + 1;
+			file << "f " << a << " " << b << " " << b + segments << " " << a + segments << "\n";
+		}
+	}
+}
+
+// Height field of n x n quads with a texture coordinate per vertex, 2n² triangles.
+inline void generateGrid(const std::string& path, const int n) {
+	std::ofstream file = openOutput(path);
+	for (int i = 0; i <= n; ++i) {
+		for (int j = 0; j <= n; ++j) {
+			const double x = static_cast<double>(j) / n * 2.0 - 1.0;
+			const double z = static_cast<double>(i) / n * 2.0 - 1.0;
+			file << "v " << x << " " << 0.1 * std::sin(x * 8.0) * std::cos(z * 8.0) << " " << z << "\n";
+		}
+	}
+	for (int i = 0; i <= n; ++i) {
+		for (int j = 0; j <= n; ++j)
+			file << "vt " << static_cast<double>(j) / n << " " << static_cast<double>(i) / n << "\n";
+	}
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			const int a = i * (n + 1) + j + 1;
+			const int b = a + n + 1;
+			file << "f " << a << "/" << a << " " << b << "/" << b << " " << b + 1 << "/" << b + 1 << " " << a + 1 << "/" << a + 1 << "\n";
+		}
+	}
+}
+
+// Icosahedron split levels times, each triangle into four, with a vn per vertex: 20 * 4^levels triangles.
+inline void generateIcosphere(const std::string& path, const int levels) {
+	const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+	std::vector<Vec3> vertices = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+		{0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+	std::vector<unsigned int> faces = {0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6,
+		7, 1, 8, 3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1};
+	for (Vec3& v : vertices)
+		v = Vec3::normalize(v);
+	for (int level = 0; level < levels; ++level) {
+		std::unordered_map<uint64_t, unsigned int> midpoints; // Shared by the two triangles of an edge
+		const auto midpoint = [&](const unsigned int a, const unsigned int b) {
+			const uint64_t key = static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+			const auto [it, inserted] = midpoints.try_emplace(key, static_cast<unsigned int>(vertices.size()));
+			if (inserted)
+				vertices.push_back(Vec3::normalize((vertices[a] + vertices[b]) * 0.5f));
+			return it->second;
+		};
+		std::vector<unsigned int> split;
+		split.reserve(faces.size() * 4);
+		for (size_t f = 0; f < faces.size(); f += 3) {
+			const unsigned int a = faces[f], b = faces[f + 1], c = faces[f + 2];
+			const unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+			split.insert(split.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+		}
+		faces.swap(split);
+	}
+	std::ofstream file = openOutput(path);
+	for (const Vec3& v : vertices)
+		file << "v " << v.x << " " << v.y << " " << v.z << "\n";
+	for (const Vec3& v : vertices)
+		file << "vn " << v.x << " " << v.y << " " << v.z << "\n";
+	for (size_t f = 0; f < faces.size(); f += 3)
+		file << "f " << faces[f] + 1 << "//" << faces[f] + 1 << " " << faces[f + 1] + 1 << "//" << faces[f + 1] + 1
+			<< " " << faces[f + 2] + 1 << "//" << faces[f + 2] + 1 << "\n";
+}
+
+// A square field of separate regular polygons of sides corners each, one face line per polygon,
+// so the parser fans sides - 2 triangles out of every line.
+inline void generatePolygons(const std::string& path, const int count, const int sides) {
+	std::ofstream file = openOutput(path);
+	const int row = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+	for (int p = 0; p < count; ++p) {
+		const double cx = p % row * 2.0, cz = p / row * 2.0;
+		for (int k = 0; k < sides; ++k) {
+			const double angle = 2.0 * M_PI * k / sides;
+			file << "v " << cx + 0.9 * std::cos(angle) << " " << 0.05 * (p % 7) << " " << cz + 0.9 * std::sin(angle) << "\n";
+		}
+	}
+	for (int p = 0; p < count; ++p) {
+		file << "f";
+		for (int k = sides; k > 0; --k) // Counter-clockwise seen from +y
+			file << " " << p * sides + k;
+		file << "\n";
+	}
+}
+
+// P6 texture with a pattern that neither compresses well in caches nor repeats with a power of two.
+inline void generatePPM(const std::string& path, const int width, const int height) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open())
+		throw RuntimeException("ERROR: Unable to write " + path);
+	file << "P6\n" << width << " " << height << "\n255\n";
+	std::vector<unsigned char> row(static_cast<size_t>(width) * 3);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			row[x * 3] = static_cast<unsigned char>((x ^ y) * 7);
+			row[x * 3 + 1] = static_cast<unsigned char>(x * 3 + y);
+			row[x * 3 + 2] = static_cast<unsigned char>(y * 5 - x);
+		}
+		file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+	}
+}
+
+#endif //GENERATORS_HPP
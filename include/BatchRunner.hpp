@@ -0,0 +1,41 @@
+#ifndef BATCHRUNNER_HPP
+#define BATCHRUNNER_HPP
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include "ObjectData.hpp"
+#include "Options.hpp"
+#include "JobSystem.hpp"
+
+// Loads a library of OBJ files without a window: directories are searched recursively, files are
+// handed out to one loader thread per job system thread, each running the usual ObjectData load
+// whose own parallel stages share the workers. Every file gets a JSON line on stdout as soon as it
+// is done, the last line sums the run up.
+class BatchRunner {
+	public:
+		static void run(const Options& options);
+
+	private:
+		std::vector<std::string> files;
+		bool strict = false;
+		std::atomic<size_t> next = 0; // Index of the next file to hand out
+		std::mutex outputMutex;
+		size_t failed = 0; // Guarded by outputMutex like the totals below
+		size_t warnings = 0;
+		uintmax_t bytes = 0;
+		explicit BatchRunner(const Options& options);
+		void worker();
+		std::string process(const std::string& path, bool& ok, uintmax_t& size, size_t& warnings) const;
+		void emit(const std::string& line, bool ok, uintmax_t size, size_t warnings);
+};
+
+#endif //BATCHRUNNER_HPP
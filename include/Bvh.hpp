@@ -0,0 +1,102 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "ansiCodes.hpp"
+
+#define BVH_BINS 16 // SAH candidates along the widest axis
+#define BVH_LEAF_TRIANGLES 4 // Ranges this small always become leaves
+#define BVH_MAX_LEAF_TRIANGLES 32 // Larger ranges are split even when SAH prefers a leaf
+#define BVH_MAX_DEPTH 64 // Also the size of the traversal stack
+#define BVH_TASK_TRIANGLES 16384 // Subtrees above this are built as separate jobs
+#define BVH_PARALLEL_BINNING 262144 // Ranges above this are binned across the job system too
+
+// Children of an inner node are stored next to each other, so one index reaches both.
+struct BvhNode {
+	Vec3 min;
+	uint32_t leftOrFirst = 0; // Left child for inner nodes, first triangle for leaves
+	Vec3 max;
+	uint32_t triangleCount = 0; // Zero for inner nodes
+};
+static_assert(sizeof(BvhNode) == 32, "Two nodes per cache line");
+
+// Triangle prepared for Moller-Trumbore, stored in leaf order.
+struct BvhTriangle {
+	Vec3 v0;
+	Vec3 edge1;
+	Vec3 edge2;
+};
+
+// Arrays a query walks, owned by the Bvh after build() or by whoever handed them to adopt().
+struct BvhView {
+	const BvhNode* nodes = nullptr;
+	size_t nodeCount = 0; // Slot 1 included
+	const BvhTriangle* triangles = nullptr;
+	const uint32_t* triangleIds = nullptr;
+	size_t triangleCount = 0;
+	size_t leafCount = 0;
+	size_t depth = 0;
+};
+
+struct RayHit {
+	float distance = INFINITY; // Set before intersect() to ignore anything farther
+	uint32_t triangle = UINT32_MAX; // Index into faces / 3
+	float u = 0.0f; // Barycentrics of the hit point along edge1 and edge2
+	float v = 0.0f;
+	[[nodiscard]] bool found() const;
+};
+
+// Bounding volume hierarchy over a triangle list, built with a binned surface area heuristic.
+// The top of the tree bins across the job system and every large subtree is its own job.
+// Nodes end up in one flat array and the triangles are copied in leaf order, so a query
+// only walks two arrays front to back.
+class Bvh {
+	public:
+		void build(const Vec3* vertices, const unsigned int* faces, size_t count); // count triangles, three indices each
+		void adopt(const BvhView& view); // Queries read the arrays in place, they must outlive the Bvh or the next clear()
+		void clear();
+		bool intersect(const Vec3& origin, const Vec3& direction, RayHit& hit) const; // Closest hit, direction need not be normalized
+		void printStats() const;
+		[[nodiscard]] bool empty() const;
+		[[nodiscard]] size_t getNodeCount() const;
+		[[nodiscard]] const BvhNode& getRoot() const; // Bounds of the whole mesh, only when not empty
+		[[nodiscard]] double getBuildMs() const;
+		[[nodiscard]] const BvhView& getView() const;
+
+	private:
+		struct Bin {
+			Vec3 min{+INFINITY, +INFINITY, +INFINITY};
+			Vec3 max{-INFINITY, -INFINITY, -INFINITY};
+			uint32_t count = 0;
+		};
+		struct BuildTriangle { // Partitioned in place so every pass over a range reads memory in order
+			Vec3 min;
+			uint32_t id;
+			Vec3 max;
+			float padding;
+		};
+		struct Build {
+			std::vector<BuildTriangle> items;
+			std::atomic<uint32_t> nodesUsed = 2; // Slot 1 stays empty so sibling pairs share a cache line
+			std::atomic<size_t> leaves = 0;
+			std::atomic<size_t> depth = 0;
+		};
+		std::vector<BvhNode> nodes;
+		std::vector<BvhTriangle> triangles;
+		std::vector<uint32_t> triangleIds; // Leaf order to original triangle
+		BvhView view{}; // Over the three arrays above, or adopted ones
+		double buildMs = 0.0;
+		void subdivide(Build& build, uint32_t node, uint32_t first, uint32_t count, size_t level);
+		void fitNode(const Build& build, BvhNode& node, uint32_t first, uint32_t count, Vec3& centroidMin, Vec3& centroidMax) const;
+		void binRange(const Build& build, uint32_t first, uint32_t count, int axis, float binMin, float toBin, Bin (&bins)[BVH_BINS]) const;
+};
+
+#endif //BVH_HPP
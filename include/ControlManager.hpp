@@ -9,7 +9,14 @@ enum Control {
     EXIT,
     RESET_POSITION,
     TOGGLE_TEXTURE,
+    CYCLE_PROJECTION,
+    TOGGLE_CULLING,
+    TOGGLE_LIGHTING,
     TOGGLE_KEY_LAYOUT,
+    ADD_INSTANCES,
+    REMOVE_INSTANCES,
+    TAKE_SCREENSHOT,
+    TOGGLE_RECORDING,
     LEFT,
     RIGHT,
     FORWARD,
@@ -0,0 +1,45 @@
+#ifndef COUNTINGRESOURCE_HPP
+#define COUNTINGRESOURCE_HPP
+
+#include <memory_resource>
+#include <algorithm>
+#include <mutex>
+
+// Memory resource that forwards to an upstream resource and keeps allocation statistics.
+// Calls into the upstream are serialized, so parser jobs can share one arena. Each loader owns
+// its own chain.
+class CountingResource final : public std::pmr::memory_resource {
+	public:
+		explicit CountingResource(std::pmr::memory_resource* upstream) : upstream(upstream) {}
+		[[nodiscard]] size_t getAllocations() const { return this->allocations; }
+		[[nodiscard]] size_t getBytes() const { return this->bytes; }
+		[[nodiscard]] size_t getPeakBytes() const { return this->peakBytes; }
+
+	private:
+		std::pmr::memory_resource* upstream;
+		size_t allocations = 0;
+		size_t bytes = 0; // Total bytes ever requested
+		size_t currentBytes = 0;
+		size_t peakBytes = 0;
+		std::mutex mutex;
+
+		void* do_allocate(const size_t size, const size_t alignment) override {
+			const std::lock_guard<std::mutex> lock(this->mutex);
+			void* p = this->upstream->allocate(size, alignment);
+			this->allocations++;
+			this->bytes += size;
+			this->currentBytes += size;
+			this->peakBytes = std::max(this->peakBytes, this->currentBytes);
+			return p;
+		}
+		void do_deallocate(void* p, const size_t size, const size_t alignment) override {
+			const std::lock_guard<std::mutex> lock(this->mutex);
+			this->upstream->deallocate(p, size, alignment);
+			this->currentBytes -= size;
+		}
+		[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			return this == &other;
+		}
+};
+
+#endif //COUNTINGRESOURCE_HPP
@@ -0,0 +1,55 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <algorithm>
+#include "exceptionTypes.hpp"
+#include "ansiCodes.hpp"
+
+#define DIAGNOSTIC_SAMPLES 5 // Line numbers kept per category for the summary
+#define DIAGNOSTIC_DETAIL 32 // Bytes kept of the offending token, longer ones are cut so collecting never allocates
+
+enum DiagnosticCategory {
+	MALFORMED_VERTEX,
+	MALFORMED_NORMAL,
+	INVALID_INDEX,
+	INDEX_OVERFLOW, // Too large to read, indices past the vertex count fail the load in validateMesh
+	SHORT_FACE,
+	INVALID_NORMAL_INDEX,
+	DIAGNOSTIC_CATEGORY_COUNT
+};
+
+// Counts load warnings by category and keeps the first few occurrences of each, so a damaged
+// file costs a counter increment per bad line instead of a flushed console write. Every parser
+// job fills its own collector, merged in file order into the one of the load.
+class Diagnostics {
+	public:
+		void add(DiagnosticCategory category, size_t line, std::string_view detail = {});
+		void merge(const Diagnostics& other, size_t lineOffset); // Throws on the first warning in strict mode
+		void clear(); // Keeps the mode
+		void setMode(bool strict, bool quiet);
+		void printSummary(const std::string& filename) const;
+		[[nodiscard]] size_t getCount(DiagnosticCategory category) const;
+		[[nodiscard]] size_t getTotal() const;
+		static const char* keyOf(DiagnosticCategory category); // Identifier for machine readable reports
+
+	private:
+		struct Sample {
+			size_t line;
+			char detail[DIAGNOSTIC_DETAIL]; // Offending token, empty when the whole line is at fault
+			size_t length;
+			[[nodiscard]] std::string_view text() const { return std::string_view(this->detail, this->length); }
+		};
+		struct Category {
+			size_t count = 0;
+			Sample samples[DIAGNOSTIC_SAMPLES];
+		};
+		Category categories[DIAGNOSTIC_CATEGORY_COUNT];
+		bool strict = false; // The first warning aborts the load
+		bool quiet = false; // Counted but never printed
+		static std::string describe(DiagnosticCategory category, const Sample& sample);
+};
+
+#endif //DIAGNOSTICS_HPP
@@ -0,0 +1,48 @@
+#ifndef DYNAMICBUFFERRING_HPP
+#define DYNAMICBUFFERRING_HPP
+
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <cstring>
+#include <algorithm>
+
+#define DYNAMIC_RING_FRAMES 3 // Regions in flight, one is written while the GPU may still read the other two
+#define DYNAMIC_RING_ALIGNMENT 256 // Of every upload, enough for any attribute or uniform block offset
+#define DYNAMIC_RING_INITIAL_SIZE (64 << 10) // Per region, grows when a frame uploads more
+
+struct DynamicRingStats {
+	size_t uploads = 0;
+	size_t bytes = 0;
+	size_t stalls = 0; // A region was still in use DYNAMIC_RING_FRAMES frames later
+	size_t grows = 0;
+};
+
+// Per-frame data goes into one buffer split in a region per frame in flight, each guarded by a
+// fence taken at the end of the frame that wrote it. With ARB_buffer_storage the buffer stays
+// mapped and uploads are plain copies. Otherwise each upload maps its range unsynchronized,
+// the fences already guarantee the GPU is done with it.
+class DynamicBufferRing {
+	public:
+		DynamicBufferRing() = default;
+		DynamicBufferRing(const DynamicBufferRing&) = delete;
+		DynamicBufferRing& operator=(const DynamicBufferRing&) = delete;
+		void beginFrame(); // The context must be current
+		void endFrame();
+		GLintptr upload(const void* data, size_t bytes); // Offset of the copy, the buffer is left bound to GL_ARRAY_BUFFER
+		[[nodiscard]] GLuint getBuffer() const;
+		[[nodiscard]] bool isPersistent() const;
+		[[nodiscard]] const DynamicRingStats& getStats() const;
+
+	private:
+		GLuint buffer = 0;
+		unsigned char* mapping = nullptr; // Whole buffer, when persistent
+		size_t regionSize = 0;
+		size_t region = 0; // Written this frame
+		size_t offset = 0; // Within the region
+		GLsync fences[DYNAMIC_RING_FRAMES] = {};
+		bool persistent = false;
+		DynamicRingStats stats{};
+		void allocate(size_t regionSize);
+};
+
+#endif //DYNAMICBUFFERRING_HPP
@@ -0,0 +1,34 @@
+#ifndef FILEWATCHER_HPP
+#define FILEWATCHER_HPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "exceptionTypes.hpp"
+
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO) // Written in place or renamed over, how exporters save
+
+// Non-blocking inotify watch on a set of files. Directories are watched rather than the files
+// themselves so a save that replaces the file with a new inode is still seen.
+class FileWatcher {
+	public:
+		FileWatcher() = default;
+		~FileWatcher();
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+		void watch(const std::string& path);
+		std::vector<std::string> poll(); // Paths written since the last call, each once, as given to watch()
+
+	private:
+		struct Watch {
+			int descriptor;
+			std::string name; // File name within the watched directory
+			std::string path;
+		};
+		int fd = -1;
+		std::vector<Watch> watches;
+};
+
+#endif //FILEWATCHER_HPP
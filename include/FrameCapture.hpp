@@ -0,0 +1,85 @@
+#ifndef FRAMECAPTURE_HPP
+#define FRAMECAPTURE_HPP
+
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <iostream>
+#include <cstring>
+#include "ansiCodes.hpp"
+#include "FrameTimer.hpp"
+
+#define CAPTURE_RING 3 // Pixel buffers in flight, a frame is copied out this many frames after it was drawn
+#define CAPTURE_QUEUE 8 // Frames waiting for the writer, later recording frames are dropped rather than stalling the render loop
+#define CAPTURE_DIR "captures"
+
+struct CaptureStats {
+	size_t frames = 0; // Read back during the current take
+	size_t dropped = 0; // The writer was CAPTURE_QUEUE frames behind, never a screenshot
+	size_t stalls = 0; // The GPU had not finished a frame CAPTURE_RING frames later
+	double renderThreadMs = 0.0; // Issuing the reads and copying mapped frames out
+};
+
+// Reads the back buffer into a ring of pixel pack buffers, each followed by a fence. A buffer is
+// mapped only once its fence has signaled, so glReadPixels never waits for the frame to finish.
+// Converting to PPM and writing the files happens on a writer thread.
+class FrameCapture {
+	public:
+		FrameCapture() = default;
+		~FrameCapture();
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+		void screenshot(); // Of the next frame
+		void toggleRecording(); // Every frame until toggled again, as a numbered PPM sequence
+		void capture(int width, int height); // After the frame is drawn, before the buffers are swapped
+		void finish(); // Writes out every pending frame and frees the GL objects, the context must be current
+		[[nodiscard]] bool isRecording() const;
+
+	private:
+		struct Slot {
+			GLuint buffer = 0;
+			GLsync fence = nullptr;
+			size_t size = 0; // Of the buffer store
+			int width = 0;
+			int height = 0;
+			bool screenshot = false; // Recording frame otherwise
+		};
+		struct Frame {
+			std::vector<unsigned char> pixels; // RGBA, bottom row first as GL returns them
+			int width;
+			int height;
+			std::string path;
+		};
+		Slot slots[CAPTURE_RING];
+		size_t head = 0; // Next slot to read into
+		bool recording = false;
+		bool screenshotPending = false;
+		std::string takePrefix;
+		size_t takeFrames = 0; // Handed to the writer, numbers the next file so a drop leaves no gap
+		int screenshotNumber = 0; // Last one named, files still queued do not exist yet
+		std::chrono::steady_clock::time_point takeStart;
+		CaptureStats stats{};
+		std::thread writer;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable room; // The writer took a frame off a full queue
+		std::deque<Frame> queue;
+		std::vector<std::vector<unsigned char>> spare; // Pixel storage the writer is done with
+		bool stopping = false;
+		std::string writeError; // First file the writer failed on
+		void issue(Slot& slot, int width, int height, bool screenshot);
+		void collect(Slot& slot, bool wait);
+		void startWriter();
+		void writeFrames();
+		void printTake();
+};
+
+#endif //FRAMECAPTURE_HPP
@@ -0,0 +1,111 @@
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#define JOB_CHUNKS_PER_THREAD 4 // parallelFor splits finer than the thread count so idle workers have something to steal
+
+class Job;
+using JobHandle = std::shared_ptr<Job>;
+
+class Job {
+	public:
+		[[nodiscard]] bool isDone() const;
+
+	private:
+		friend class JobSystem;
+		std::function<void()> function;
+		std::atomic<size_t> pendingDependencies = 1; // The extra count is held by submit while dependencies are wired
+		std::atomic<bool> done = false;
+		std::mutex dependentsMutex;
+		std::vector<JobHandle> dependents; // Released when this job finishes
+};
+
+// Work-stealing scheduler sized to the machine. Every worker owns a deque: it pushes and pops
+// at the back, idle workers steal from the front of the others. Threads that are not workers
+// (main, loader, texture decoder) share one extra deque and help run jobs while they wait, so
+// a thread count of one runs everything inline. Background jobs sit in their own queue that only
+// workers take from, so a long job never runs inline on a thread that is only helping while it
+// waits. Without workers a dedicated thread serves that queue. Jobs must not throw.
+class JobSystem {
+	public:
+		static JobSystem& getInstance();
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+		void* operator new(size_t) = delete;
+		void operator delete(void*) = delete;
+		JobHandle submit(std::function<void()> function, std::initializer_list<JobHandle> dependencies = {});
+		JobHandle submitBackground(std::function<void()> function); // Whole jobs that must not stall a waiting thread, may split into ordinary jobs
+		bool cancel(const JobHandle& job); // Background jobs only, true when it never ran
+		void wait(const JobHandle& job);
+		template <typename Function>
+		void parallelFor(size_t count, size_t minChunk, Function&& function);
+		[[nodiscard]] size_t chunkCount(size_t count, size_t minChunk) const;
+		void setThreadCount(size_t threads); // Total threads including the caller, only while no job is in flight
+		[[nodiscard]] size_t getThreadCount() const;
+		[[nodiscard]] size_t getSteals() const;
+
+	private:
+		struct Queue {
+			std::mutex mutex;
+			std::deque<JobHandle> jobs;
+		};
+		std::vector<std::unique_ptr<Queue>> queues; // Index 0 is shared by external threads
+		Queue background;
+		std::vector<std::thread> workers;
+		std::thread backgroundThread; // Only when there are no workers
+		std::mutex sleepMutex;
+		std::condition_variable wake;
+		std::atomic<size_t> queued = 0;
+		std::atomic<size_t> backgroundQueued = 0;
+		std::atomic<size_t> steals = 0;
+		bool stopping = false;
+		static thread_local size_t queueIndex;
+		void start(size_t threads);
+		void stop();
+		void workerLoop(size_t index);
+		void backgroundLoop();
+		void push(JobHandle job);
+		JobHandle pop();
+		JobHandle popBackground();
+		void run(const JobHandle& job);
+		void finish(const JobHandle& job);
+		bool helpOnce();
+		JobSystem();
+		~JobSystem();
+};
+
+// Calls function(begin, end, chunk) once per chunk, the calling thread runs the last chunk and
+// then helps with the others. chunkCount() tells how many chunks a call will use.
+template <typename Function>
+void JobSystem::parallelFor(const size_t count, const size_t minChunk, Function&& function) {
+	const size_t chunks = this->chunkCount(count, minChunk);
+	const size_t step = (count + chunks - 1) / chunks;
+	if (chunks == 1) {
+		function(0, count, 0);
+		return;
+	}
+	std::atomic<size_t> remaining = chunks - 1;
+	for (size_t chunk = 0; chunk + 1 < chunks; ++chunk) {
+		this->submit([&function, &remaining, chunk, step, count] {
+			function(std::min(count, chunk * step), std::min(count, (chunk + 1) * step), chunk);
+			remaining.fetch_sub(1, std::memory_order_release);
+		});
+	}
+	function(std::min(count, (chunks - 1) * step), count, chunks - 1);
+	while (remaining.load(std::memory_order_acquire) > 0) {
+		if (!this->helpOnce())
+			std::this_thread::yield();
+	}
+}
+
+#endif //JOBSYSTEM_HPP
@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "exceptionTypes.hpp"
+
+// RAII wrapper around a whole-file mmap. Read-only mappings are shared with the page cache,
+// writable ones are created (or truncated) to the requested size first.
+class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		void openReadOnly(const std::string& path);
+		void create(const std::string& path, size_t size);
+		void close();
+		void release(size_t offset, size_t length) const; // Drop pages from residency, they are re-read on access
+		void prefetch(size_t offset, size_t length) const;
+		[[nodiscard]] unsigned char* data() const;
+		[[nodiscard]] size_t size() const;
+
+	private:
+		unsigned char* mapping = nullptr;
+		size_t length = 0;
+		int fd = -1;
+		void map(int protection, const std::string& path);
+};
+
+#endif //MAPPEDFILE_HPP
@@ -0,0 +1,44 @@
+#ifndef MESHCHUNKER_HPP
+#define MESHCHUNKER_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include "chunkFormat.hpp"
+#include "MappedFile.hpp"
+#include "objParser.hpp"
+#include "ansiCodes.hpp"
+#include "exceptionTypes.hpp"
+
+// Converts an OBJ into the .smc streaming format without ever holding the mesh in memory.
+// Positions and triangles are spilled to temporary files next to the output and mapped back,
+// triangles are bucketed by a coarse grid over their centroids with a counting sort, and each
+// bucket is cut into clusters of CHUNK_TRIANGLES.
+class MeshChunker {
+	public:
+		static void build(const std::string& objPath);
+
+	private:
+		std::string outPath;
+		uint64_t vertexCount = 0;
+		uint64_t triangleCount = 0;
+		uint64_t skippedFaces = 0;
+		double sum[3] = {0.0, 0.0, 0.0};
+		float min[3] = {+INFINITY, +INFINITY, +INFINITY};
+		float max[3] = {-INFINITY, -INFINITY, -INFINITY};
+		ChunkFileHeader header{};
+		ProjectionSetup projection{};
+		MappedFile positions;
+		MappedFile triangles;
+		explicit MeshChunker(std::string outPath);
+		void spill(const std::string& objPath);
+		void computeQuantization();
+		void writeClusters();
+		[[nodiscard]] Vec3 vertexAt(uint64_t index) const;
+};
+
+#endif //MESHCHUNKER_HPP
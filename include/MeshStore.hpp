@@ -0,0 +1,92 @@
+#ifndef MESHSTORE_HPP
+#define MESHSTORE_HPP
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cerrno>
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ansiCodes.hpp"
+#include "exceptionTypes.hpp"
+
+#define MESH_STORE_PREFIX "scop-" // Segments show up as /dev/shm/scop-<user>-<device>-<inode>-<size>-<mtime>
+#define MESH_STORE_DIR "/dev/shm"
+#define MESH_STORE_VERSION 2 // Bump whenever anything stored changes layout
+#define MESH_STORE_ARRAYS 16
+#define MESH_STORE_ALIGNMENT 64
+#define MESH_STORE_POLL_MS 10 // While another process is still publishing
+
+enum MeshStoreState : uint32_t {
+	MESH_STORE_WRITING, // Readers wait, it only takes a copy
+	MESH_STORE_READY, // Every array but the last can be read
+	MESH_STORE_COMPLETE // The last one too, it may never get there
+};
+
+struct MeshStoreHeader {
+	std::atomic<uint32_t> state;
+	uint32_t version;
+	int32_t writer; // Process that publishes it, a dead one leaves a stale segment behind
+	uint32_t arrayCount;
+	uint64_t capacity; // Mapped length, the file is trimmed below it once complete
+	uint64_t offsets[MESH_STORE_ARRAYS];
+	uint64_t sizes[MESH_STORE_ARRAYS]; // In bytes
+};
+
+// A processed mesh in a POSIX shared memory segment named after the identity of its source file,
+// so every process opening the same unchanged file maps one copy. The writer creates it
+// exclusively and fills it, readers map it read-only. The last array is published separately:
+// it is reserved larger than needed and only filled and trimmed by complete(). The segment is
+// removed once no process maps it anymore.
+class MeshStore {
+	public:
+		MeshStore() = default;
+		~MeshStore();
+		MeshStore(const MeshStore&) = delete;
+		MeshStore& operator=(const MeshStore&) = delete;
+		static std::string nameOf(const std::string& path); // Empty when the file cannot be stat'ed
+		bool open(const std::string& name); // False when no usable published segment exists and nobody is writing one
+		bool create(const std::string& name, const std::vector<size_t>& sizes); // False when another process got there first
+		void publish(); // Every array but the last is filled
+		void resizeLast(size_t bytes); // Before it is filled, at most the size given to create()
+		void complete();
+		void close(); // A segment this process never published, or that nobody else maps, is removed
+		template <typename T>
+		[[nodiscard]] T* array(const size_t index) const {
+			return reinterpret_cast<T*>(this->mapping + this->header()->offsets[index]);
+		}
+		template <typename T>
+		[[nodiscard]] size_t count(const size_t index) const {
+			return this->header()->sizes[index] / sizeof(T);
+		}
+		[[nodiscard]] bool isOpen() const;
+		[[nodiscard]] bool isOwner() const; // Created by this process
+		[[nodiscard]] bool isComplete() const;
+		[[nodiscard]] size_t arrayCount() const;
+		[[nodiscard]] size_t size() const;
+		[[nodiscard]] const std::string& getName() const;
+
+	private:
+		unsigned char* mapping = nullptr;
+		size_t length = 0;
+		int fd = -1;
+		bool owner = false;
+		bool locked = false; // Holds the shared lock every mapping process takes
+		std::string name;
+		[[nodiscard]] MeshStoreHeader* header() const;
+		bool map(int protection);
+		[[nodiscard]] bool fitsIn(size_t fileSize) const;
+		void removeOlderVersions() const;
+};
+
+#endif //MESHSTORE_HPP
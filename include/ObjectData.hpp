@@ -4,69 +4,363 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <memory_resource>
 #include <sstream>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <exception>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <sys/resource.h>
 #include <GL/gl.h>
+#include <GL/glext.h>
 #include "exceptionTypes.hpp"
 #include "ansiCodes.hpp"
 #include "matrix.hpp"
 #include "FrameTimer.hpp"
-#include "ControlManager.hpp"
+#include "parallel.hpp"
+#include "CountingResource.hpp"
+#include "objParser.hpp"
+#include "vertexFormat.hpp"
+#include "cluster.hpp"
+#include "Bvh.hpp"
+#include "SpatialHash.hpp"
+#include "Diagnostics.hpp"
+#include "contentHash.hpp"
+#include "ShaderProgram.hpp"
+#include "StreamedMesh.hpp"
+#include "MeshStore.hpp"
+#include "RenderState.hpp"
+#include "Options.hpp"
+#include "StartupTimeline.hpp"
+#include "shaders.hpp"
 
 #define TEX_PATH "assets/textures/texture.ppm"
+#define BOUNDS_MIN_CHUNK 65536 // Vertices per thread below which the bounds reduction stays serial
+#define ATTRIB_MIN_CHUNK 16384 // Triangles per thread below which attribute generation stays serial
+#define ATTRIB_BLOCK 256 // Triangles gathered into SoA scratch at once by computeAttributes
+#define LOAD_ARENA_SIZE (1 << 20) // Initial arena block for load-time temporaries
+#define LOAD_BUFFER_SIZE (1 << 22) // OBJ bytes read per block, grows if a single line is longer
+#define PARSE_MIN_CHUNK (1 << 16) // Bytes per parser job below which a block is not split further
+#define TEXTURE_MIN_CHUNK (1 << 16) // Pixels per job for the PPM swizzle and mip filtering
+#define WELD_TOLERANCE 1e-6f // Fraction of the bounding box diagonal under which two positions are welded
+#define DEGENERATE_TOLERANCE 1e-6f // Triangle height over its longest edge below which it is treated as a line
+#define NORMAL_CREASE_ANGLE 60.0f // Degrees between two faces above which a shared vertex gets split normals
+#define NO_NORMAL UINT32_MAX // Corner without a vn reference, its normal is generated
+#define BEFORE_FIRST_INDEX (UINT32_MAX - 1) // Relative index reaching back past the first element, rejected as out of range
+#define RELATIVE_VERTEX 1 // Polygon corner bits, the index is negative and resolved once the chunk is merged
+#define RELATIVE_NORMAL 2
+#define MESHLET_TRIANGLES 128 // Triangles per culling cluster
+#define CULL_MIN_INSTANCES 16 // Instances per culling job
+#define INSTANCED_MIN_INSTANCES 4 // From this many instances the ones inside the frustum share an instanced draw
+#define PREVIEW_BATCH 65536 // Triangles handed from the loader thread to the renderer at once
 
-struct VertexAttrib {
-	Vec3 position;
-	Vec3 color;
-	Vec2 texCoord;
+struct VertexQuantization {
+	Vec3 positionScale; // Dequantized position = normalized * positionScale + positionOffset
+	Vec3 positionOffset;
+	float texCoordTransform[PROJECTION_COUNT][4]{}; // xy scale, zw offset, same rule for UVs
+	float positionError = 0.0f; // Largest measured error, in object units
+	float positionBound = 0.0f; // Worst case error allowed by the step size
+	float texCoordError[PROJECTION_COUNT]{};
+};
+
+struct LoadStats {
+	size_t temporaryAllocations = 0; // Requests served by the load arena
+	size_t temporaryBytes = 0;
+	size_t heapAllocations = 0; // Blocks the arena itself took from the heap
+	size_t arenaPeakBytes = 0;
+	double parseMs = 0.0; // Reading and tokenizing the file, before validation and the mesh build
+	double attributesMs = 0.0; // Packing positions and texture coordinates, see computeAttributes
+};
+
+struct NormalStats {
+	size_t fileCorners = 0; // Corners with a usable vn reference
+	size_t generatedCorners = 0;
+	size_t droppedReferences = 0; // vn references past the end of the normal list
+	double ms = 0.0;
+};
+
+struct IndexStats {
+	size_t vertices = 0; // Corners of one source vertex with the same normal and UVs share one
+	size_t shadeCopies = 0; // Extra vertices for triangles whose corners all provoke another shade
+	double ms = 0.0;
+};
+
+// GL names of the resident mesh, each with the hash of what it holds so a reload can keep it.
+struct MeshBuffers {
+	GLuint vertices = 0;
+	GLuint normals = 0;
+	GLuint texCoords[PROJECTION_COUNT]{};
+	GLuint indices = 0;
+	uint64_t vertexHash = 0;
+	uint64_t normalHash = 0;
+	uint64_t texCoordHashes[PROJECTION_COUNT]{};
+	uint64_t indexHash = 0;
+};
+
+struct UploadStats {
+	size_t uploadedBuffers = 0;
+	size_t reusedBuffers = 0; // Same content as in the previous version of the file
+	size_t uploadedBytes = 0;
+};
+
+struct RepairStats {
+	size_t inputTriangles = 0;
+	size_t weldedVertices = 0;
+	size_t degenerateTriangles = 0;
+	size_t duplicateTriangles = 0;
+};
+
+enum SharedArray { // Arrays of a mesh in the shared store, the BVH nodes last because their count is only known after the build
+	SHARED_INFO,
+	SHARED_VERTICES,
+	SHARED_NORMALS,
+	SHARED_TEXCOORDS,
+	SHARED_INDICES = SHARED_TEXCOORDS + PROJECTION_COUNT,
+	SHARED_MESHLETS,
+	SHARED_POSITIONS, // With the faces, what a process needs to build the BVH when the publisher has not yet
+	SHARED_FACES,
+	SHARED_BVH_TRIANGLES,
+	SHARED_BVH_IDS,
+	SHARED_BVH_NODES,
+	SHARED_ARRAY_COUNT
+};
+
+// Everything else a process needs to draw and pick a shared mesh without parsing it.
+struct SharedMeshInfo {
+	VertexQuantization quantization;
+	Vec3 center;
+	float bounds[6]; // Min then max, x y z
+	float maxDistance;
+	uint32_t closedMesh;
+	uint64_t sourceVertices; // As parsed, before welding
+	uint64_t corners;
+	uint64_t vertexHash;
+	uint64_t normalHash;
+	uint64_t texCoordHashes[PROJECTION_COUNT];
+	uint64_t indexHash;
+	RepairStats repair;
+	NormalStats normals;
+	IndexStats indexing;
+	uint64_t bvhLeafCount;
+	uint64_t bvhDepth;
+};
+
+// Output of one parser job. Chunks are reused from block to block so their vectors only grow
+// a few times per load, from the load arena like every other temporary.
+struct ParseChunk {
+	using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+	std::pmr::vector<Vec3> vertices;
+	std::pmr::vector<Vec3> normals;
+	std::pmr::vector<unsigned int> faces;
+	std::pmr::vector<unsigned int> normalIndices; // Parallel to faces from the first face with a vn reference on
+	std::pmr::vector<size_t> relativeFaces; // Corners holding a negative index, counted from the chunk's first vertex until the merge
+	std::pmr::vector<size_t> relativeNormals; // Same for normalIndices, from the chunk's first normal
+	std::pmr::vector<unsigned int> face; // Polygon being read
+	std::pmr::vector<unsigned int> faceNormals;
+	std::pmr::vector<unsigned char> faceRelative; // RELATIVE_ bits of each polygon corner
+	Diagnostics diagnostics; // Lines within the chunk, merged in file order
+	size_t lines = 0;
+	explicit ParseChunk(const allocator_type& allocator) : vertices(allocator), normals(allocator), faces(allocator),
+		normalIndices(allocator), relativeFaces(allocator), relativeNormals(allocator), face(allocator), faceNormals(allocator),
+		faceRelative(allocator) {}
+	ParseChunk(ParseChunk&& other, const allocator_type& allocator) : vertices(std::move(other.vertices), allocator),
+		normals(std::move(other.normals), allocator), faces(std::move(other.faces), allocator),
+		normalIndices(std::move(other.normalIndices), allocator), relativeFaces(std::move(other.relativeFaces), allocator),
+		relativeNormals(std::move(other.relativeNormals), allocator), face(std::move(other.face), allocator),
+		faceNormals(std::move(other.faceNormals), allocator), faceRelative(std::move(other.faceRelative), allocator),
+		diagnostics(other.diagnostics), lines(other.lines) {}
+};
+
+struct PreviewVertex {
+	float position[3]; // Raw OBJ coordinates, the shader re-centers them on the provisional centroid
+	uint8_t shade;
+	uint8_t padding[3];
+};
+
+struct PreviewBounds {
+	float min[3] = {+INFINITY, +INFINITY, +INFINITY};
+	float max[3] = {-INFINITY, -INFINITY, -INFINITY};
+	double sum[3] = {0.0, 0.0, 0.0};
+	size_t vertexCount = 0;
+};
+
+struct PreviewBatch {
+	std::vector<PreviewVertex> corners;
+	PreviewBounds bounds; // Every vertex parsed so far, not only the ones of this batch
+};
+
+struct CullStats {
+	size_t frames = 0;
+	size_t tested = 0; // Meshlet instances considered
+	size_t frustumCulled = 0;
+	size_t coneCulled = 0;
 };
 
 struct PPMData {
 	int width;
 	int height;
 	unsigned char* data;
+	std::vector<std::vector<unsigned char>> mipLevels; // Level 1 onward, each half the size of the previous
+	uint64_t hash = 0; // Of level 0
 };
 
+// One mesh and its texture. The scene owns one per file and decides which instances it draws.
 class ObjectData {
   	public:
-    	static ObjectData& getInstance();
+		ObjectData() = default;
+		~ObjectData();
 		ObjectData(const ObjectData&) = delete;
 		ObjectData& operator=(const ObjectData&) = delete;
-		void* operator new(size_t) = delete;
-		void operator delete(void*) = delete;
 		void load(const char* filepath);
+		void loadAsync(const char* filepath, bool progressive = true); // Without progressive, nothing is drawn until it is done
+		void finishReload(ObjectData& previous); // Once isLoaded(), replaces previous which can then be destroyed
+		void unload();
 		void loadPPM(const char *filepath);
-		void draw();
+		void decodePPMAsync(const char* filepath);
+		void uploadTexture();
+		void reloadTexture(); // Decodes texturePath again in the background, update() uploads it if it changed
+		void releaseBuffers();
+		void shareTexture(const ObjectData& owner); // Draws with the texture of owner instead of decoding its own
+		void decodePPM(const char* filepath);
+		void update();
+		void meshToOpenGL(ObjectData* previous = nullptr); // Buffers of previous are reused or refilled
+		void draw(RenderState& state, const ShaderProgram& shader, const Mat4& projection, const Mat4* modelViews, size_t count);
 		void printInfo() const;
-		void moveObject(int control, float speed = 1.5f);
+		void printLoadStats() const;
+		void printQuantization() const;
 		void toggleTexture();
+		void cycleProjection();
+		void toggleCulling();
+		void toggleLighting();
+		void setStreamBudget(size_t bytes);
+		void setDiagnosticsMode(bool strict, bool quiet);
+		void setSharedStore(bool enabled); // Map the mesh from shared memory when another process published it, publish it otherwise
+		void setHeadless(bool headless); // Nothing printed and no BVH, for batch runs that only measure the mesh
+		void printRenderStats() const;
 		[[nodiscard]] const std::string& getFilename() const;
-		[[nodiscard]] const Vec3& getPosition() const;
 		[[nodiscard]] const Vec3& getCenter() const;
 		[[nodiscard]] float getMaxDistance() const;
+		[[nodiscard]] bool isReady() const;
+		[[nodiscard]] bool isLoaded() const; // The background load finished, successfully or not
+		[[nodiscard]] bool isDecodingTexture() const;
+		[[nodiscard]] bool isStreamed() const;
+		[[nodiscard]] GLuint getTextureID() const;
+		[[nodiscard]] const NormalStats& getNormalStats() const;
+		[[nodiscard]] const RepairStats& getRepairStats() const;
+		[[nodiscard]] const LoadStats& getLoadStats() const;
+		[[nodiscard]] const Diagnostics& getDiagnostics() const;
+		[[nodiscard]] size_t getVertexCount() const; // As parsed, before welding
+		[[nodiscard]] size_t getTriangleCount() const; // After repair
+		[[nodiscard]] Vec3 getMin() const; // In file coordinates, the mesh itself is re-centered
+		[[nodiscard]] Vec3 getMax() const;
+		[[nodiscard]] const Bvh& getBvh() const; // Waits for the background build
+		bool pick(const Mat4* modelViews, size_t count, const Vec3& origin, const Vec3& direction, RayHit& hit, size_t& instance) const;
     
    	private:
-		ObjectData() = default;
-		~ObjectData();
 		std::string filename;
 		std::vector<Vec3> vertices;
 		std::vector<unsigned int> faces;
-		std::vector<VertexAttrib> attributes; // Attributes for each vertex, including position and color
-		std::vector<unsigned int> indices;
-		Vec3 position{0.0f, 0.0f, 0.0f};
+		std::vector<Vec3> normals; // OBJ vn lines
+		std::vector<unsigned int> normalIndices; // Per corner like faces, empty when the file references no normal
+		std::vector<PackedVertex> packedVertices; // Indexed by indices, released once uploaded
+		std::vector<PackedNormal> packedNormals; // Parallel to packedVertices, in their own buffer so .smc clusters keep their layout
+		std::vector<Vec2> texCoords[PROJECTION_COUNT]; // Float UVs, only alive until packTexCoords
+		std::vector<PackedTexCoord> packedTexCoords[PROJECTION_COUNT]; // Every projection is built at load so switching is free
+		std::vector<uint32_t> indices; // Three per triangle in meshlet order, the last one provokes its flat shade
+		IndexStats indexStats{};
+		TextureProjection projection = PLANAR;
+		VertexQuantization quantization{};
+		MeshBuffers buffers{};
+		UploadStats uploadStats{};
+		GLsizei vertexCount = 0; // Triangle corners, the number of indices drawn
+		std::vector<ClusterBounds> meshlets; // Meshlet m draws triangles [m * MESHLET_TRIANGLES, (m + 1) * MESHLET_TRIANGLES)
+		std::vector<std::vector<const void*>> drawOffsets; // Per instance runs of visible meshlets in the index buffer, merged when contiguous
+		std::vector<std::vector<GLsizei>> drawCounts;
+		std::vector<size_t> instanceFrustumCulled;
+		std::vector<size_t> instanceConeCulled;
+		std::vector<unsigned char> instanceBatched; // Entirely in the frustum, drawn whole with the others
+		std::vector<Mat4> visibleModelViews; // Those instances, uploaded for one instanced draw
+		CullStats cullStats{};
+		bool culling = true;
+		bool lighting = true;
+		NormalStats normalStats{};
+		Bvh bvh; // Over faces in meshlet order, kept for picking once the GPU has the mesh
+		JobHandle bvhJob; // Builds bvh in the background after load
+		bool closedMesh = false; // Every edge shared by exactly two triangles in opposite directions
+		std::unique_ptr<StreamedMesh> stream; // Set when a .smc is loaded, the mesh then never lives in memory
+		size_t streamBudget = static_cast<size_t>(STREAM_BUDGET_MB) << 20;
+		bool shareMesh = false;
+		bool headless = false;
+		MeshStore store; // The segment this mesh was mapped from or is being published to
+		double sharedMapMs = -1.0; // Set when the load was served by the store
 		Vec3 center{0.0f, 0.0f, 0.0f}; // Center of the object
 		size_t lineIndex = 0; // For error reporting
+		LoadStats loadStats{};
+		RepairStats repairStats{};
+		Diagnostics diagnostics; // Parse warnings of the current file
+		std::thread loader; // Parses and builds the mesh while the window already draws the preview
+		std::atomic<bool> loaderDone = false;
+		std::atomic<bool> loadCancelled = false;
+		std::exception_ptr loaderError;
+		std::mutex previewMutex;
+		std::vector<PreviewBatch> pendingPreview; // Published by the loader, drained by update()
+		PreviewBounds previewBounds{}; // Loader side
+		size_t publishedCorners = 0; // Loader side
+		bool progressive = false;
+		std::vector<std::pair<GLuint, GLsizei>> previewBuffers; // One buffer per received batch
+		Vec3 previewCenter{0.0f, 0.0f, 0.0f};
+		float previewRadius = 0.0f;
+		size_t previewTriangles = 0;
+		bool meshReady = false; // Final buffers are uploaded, the getters stop reporting provisional bounds
+		std::chrono::steady_clock::time_point loadStart;
+		double firstTrianglesMs = -1.0;
 		PPMData ppmData{};
+		std::string texturePath;
+		std::thread textureLoader; // Decodes the PPM while the window and the mesh are being prepared
+		std::exception_ptr textureError;
+		std::atomic<bool> textureDecoded = false;
+		std::chrono::steady_clock::time_point textureReloadStart;
+		uint64_t textureHash = 0; // Of the pixels last uploaded
 		GLuint textureID = 0;
 		float minX = +INFINITY, minZ = +INFINITY, minY = +INFINITY;
 		float maxX = -INFINITY, maxZ = -INFINITY, maxY = -INFINITY;
 		float transitionFactor = 0.0f; // For texture transition
-		float maxDistance = 0.0f; // Max distance from the center
+		float maxDistance = 0.0f; // Bounding sphere radius around the center
 		bool showTexture = false;
-		void getFace(std::istringstream& iss);
-		void computeCenter();
+		[[nodiscard]] size_t beginStage(const char* stage, std::initializer_list<const char*> dependencies = {}) const;
+		void parseBlock(std::string_view block, std::pmr::vector<ParseChunk>& chunks);
+		void loadFile(const char* filepath);
+		void loadChunked(const char* filepath);
+		bool loadShared(const std::string& name);
+		void publishShared(const std::string& name);
+		void queueBvh();
+		void finishShared();
+		void adoptSharedBvh();
+		void bindBuffers() const;
+		void drawStream(RenderState& state, const Mat4* modelViews, size_t count);
+		void publishPreview();
+		void pollLoader();
+		void drawPreview(RenderState& state, const Mat4* modelViews, size_t count);
+		void computeBounds();
+		void validateMesh();
+		void computeNormals();
 		void computeAttributes();
-		void computeUVBound();
-		void computeMaxDistance();
+		void hashBuffers();
+		void pollTexture();
+		void packTexCoords();
+		void buildMeshlets();
+		void indexCorners();
+		void waitForBvh() const;
+		void cancelBvh();
+		void cullMeshlets(const Mat4& projection, const Mat4* modelViews, size_t count, bool batchInside);
+		void buildMipLevel(size_t index);
 		void dataToOpenGL();
 };
 
@@ -0,0 +1,25 @@
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "exceptionTypes.hpp"
+
+#define STREAM_BUDGET_MB 256 // Default GPU residency budget of a streamed .smc mesh
+#define SCENE_MESH_LIMIT 8 // Files one scene can open side by side, batch runs take any number
+
+struct Options {
+	std::vector<std::string> paths; // Every mesh of the scene, instances alternate between them
+	bool chunk = false; // Convert the .obj into a .smc next to it instead of opening a window
+	bool batch = false; // Load every file and directory given without a window, report stats as JSON lines
+	size_t streamBudget = static_cast<size_t>(STREAM_BUDGET_MB) << 20;
+	bool strict = false; // Abort the load on the first malformed line
+	bool quiet = false; // No warning summary, for batch runs
+	size_t instances = 1; // Instances on screen at startup, the +/- keys change it later
+	bool share = true; // Map meshes other processes already loaded from /dev/shm, publish the others until the last user exits
+};
+
+Options parseOptions(int argc, const char* argv[]);
+
+#endif //OPTIONS_HPP
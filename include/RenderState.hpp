@@ -0,0 +1,54 @@
+#ifndef RENDERSTATE_HPP
+#define RENDERSTATE_HPP
+
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <iostream>
+#include "matrix.hpp"
+#include "vertexFormat.hpp"
+#include "ansiCodes.hpp"
+#include "DynamicBufferRing.hpp"
+
+#define ATTRIB_BIT(location) (1u << (location))
+
+struct RenderStats {
+	size_t frames = 0;
+	size_t drawCalls = 0; // Instanced draws included
+	size_t instancedDrawCalls = 0;
+	size_t programChanges = 0;
+	size_t textureChanges = 0;
+	size_t meshChanges = 0; // Vertex buffers rebound because another mesh is drawn
+	size_t attributeChanges = 0; // Vertex attribute arrays enabled or disabled
+	size_t instanceUploads = 0;
+	size_t instanceBytes = 0;
+};
+
+// Shadows the GL state a frame touches and only issues calls that change it, counting every
+// change. The scene sorts its draws so consecutive ones share as much of this state as possible.
+class RenderState {
+	public:
+		void beginFrame();
+		void endFrame();
+		void useProgram(GLuint program);
+		void bindTexture(GLuint texture);
+		bool bindMesh(const void* mesh); // True when the caller has to point the attributes at its buffers
+		void enableAttributes(unsigned int mask); // ATTRIB_BIT of every array to source, ATTRIB_MODELVIEW stands for its 4 columns
+		void setModelView(const Mat4& modelView); // Constant value of the model-view attribute while its array is disabled
+		void setInstances(const Mat4* modelViews, size_t count); // Array the model-view attribute reads per instance
+		void drawArrays(GLint first, GLsizei corners);
+		void drawArraysInstanced(GLint first, GLsizei corners, GLsizei instances);
+		void multiDrawElements(const GLsizei* counts, const void* const* offsets, GLsizei draws); // 32-bit indices, offsets in bytes
+		void drawElementsInstanced(GLsizei corners, GLsizei instances);
+		void printStats() const;
+		[[nodiscard]] const RenderStats& getStats() const;
+
+	private:
+		GLuint program = 0;
+		GLuint texture = 0;
+		const void* mesh = nullptr;
+		unsigned int attributes = 0;
+		DynamicBufferRing instances; // Matrices of every instanced draw, written without waiting for the GPU
+		RenderStats stats{};
+};
+
+#endif //RENDERSTATE_HPP
@@ -0,0 +1,76 @@
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <tuple>
+#include "ObjectData.hpp"
+#include "TransformStore.hpp"
+#include "RenderState.hpp"
+#include "ShaderProgram.hpp"
+#include "Options.hpp"
+#include "FileWatcher.hpp"
+
+#define INSTANCE_LIMIT 16384
+
+enum DrawPipeline { // Attribute layouts, in the order the scene submits them
+	PIPELINE_PREVIEW,
+	PIPELINE_STREAMED,
+	PIPELINE_RESIDENT
+};
+
+// Every mesh of the session with its instances. Instance i belongs to mesh i % meshes and sits
+// on one shared grid. draw() sorts the meshes by pipeline and texture so each one is bound once
+// per frame and all its instances go out together. Files saved while the window is open are
+// parsed again in the background and swapped in by update(), between two frames.
+class Scene {
+	public:
+		static Scene& getInstance();
+		Scene(const Scene&) = delete;
+		Scene& operator=(const Scene&) = delete;
+		void* operator new(size_t) = delete;
+		void operator delete(void*) = delete;
+		void load(const Options& options); // Starts every loader, the first mesh also decodes the texture
+		void upload(); // The context must be current
+		void setInstanceCount(size_t count);
+		void update(const Affine& view, float rotationAngle);
+		void draw(const Mat4& projection);
+		void moveObject(int control, float speed = 1.5f);
+		void toggleTexture();
+		void cycleProjection();
+		void toggleCulling();
+		void toggleLighting();
+		void printRenderStats() const;
+		bool pick(const Vec3& origin, const Vec3& direction, RayHit& hit, size_t& mesh, size_t& instance) const;
+		[[nodiscard]] size_t getInstanceCount() const;
+		[[nodiscard]] size_t getMeshCount() const;
+		[[nodiscard]] const ObjectData& getMesh(size_t index) const;
+		[[nodiscard]] float getMaxDistance() const; // Of the largest mesh
+		[[nodiscard]] bool isReady() const; // Every mesh is uploaded
+
+	private:
+		std::vector<std::unique_ptr<ObjectData>> meshes;
+		std::vector<std::unique_ptr<ObjectData>> reloads; // Per mesh, the new version while it parses
+		std::vector<bool> reloadQueued; // Saved again during its reload
+		Options options; // Of load(), reloads open their file the same way
+		FileWatcher watcher;
+		std::vector<TransformStore> instances; // Per mesh
+		std::vector<size_t> drawOrder;
+		ShaderProgram shader;
+		RenderState state;
+		Vec3 position{0.0f, 0.0f, 0.0f}; // Moves every mesh together
+		size_t instanceCount = 0;
+		float spacing = 0.0f; // Grid step the instances were laid out with
+		void layoutInstances();
+		[[nodiscard]] std::unique_ptr<ObjectData> openMesh(const std::string& path, bool progressive) const;
+		void watch(const std::string& path);
+		void startReload(size_t index);
+		void pollReloads();
+		[[nodiscard]] DrawPipeline pipelineOf(const ObjectData& mesh) const;
+		Scene() = default;
+		~Scene() = default;
+};
+
+#endif //SCENE_HPP
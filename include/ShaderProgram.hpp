@@ -0,0 +1,30 @@
+#ifndef SHADERPROGRAM_HPP
+#define SHADERPROGRAM_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include "exceptionTypes.hpp"
+
+class ShaderProgram {
+	public:
+		ShaderProgram() = default;
+		~ShaderProgram();
+		ShaderProgram(const ShaderProgram&) = delete;
+		ShaderProgram& operator=(const ShaderProgram&) = delete;
+		void build(const char* vertexSource, const char* fragmentSource,
+			const std::vector<std::pair<GLuint, const char*>>& attributes);
+		void use() const;
+		[[nodiscard]] GLint uniform(const char* name) const;
+		[[nodiscard]] GLuint getProgram() const;
+		[[nodiscard]] bool isBuilt() const;
+
+	private:
+		GLuint program = 0;
+		static GLuint compile(GLenum type, const char* source);
+};
+
+#endif //SHADERPROGRAM_HPP
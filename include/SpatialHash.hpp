@@ -0,0 +1,64 @@
+#ifndef SPATIALHASH_HPP
+#define SPATIALHASH_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include "matrix.hpp"
+#include "parallel.hpp"
+
+#define SPATIAL_HASH_MIN_CHUNK 65536 // Points per job when computing cells
+#define SPATIAL_HASH_CELL_RADII 16.0f // Cell edge in query radii, so most queries stay inside one cell
+
+// Uniform grid over a point set where a cell is found through a hash of its integer coordinates
+// (Teschner et al. 2003), so memory follows the point count and not the extent. Buckets are
+// laid out as one array sorted by bucket with an offset table, built by a counting sort.
+// Cells are much larger than the query radius, and a query only steps into a neighbour when
+// the point is within the radius of the face they share.
+class SpatialHash {
+	public:
+		SpatialHash(const std::vector<Vec3>& points, const Vec3& origin, float radius); // points must outlive the hash, origin keeps cell coordinates small
+		template <typename Visit>
+		void forEachNear(size_t point, Visit&& visit) const; // visit(index) for every point of the cells the radius reaches, a superset of the answer
+
+	private:
+		struct Cell {
+			int32_t x, y, z;
+			bool operator==(const Cell& other) const;
+		};
+		const std::vector<Vec3>& points;
+		Vec3 origin;
+		float toCell; // Inverse cell edge
+		float reach = 1.0f / SPATIAL_HASH_CELL_RADII; // Radius in cell units
+		std::vector<Cell> cells; // Per point
+		std::vector<uint32_t> bucketStart; // Offsets into items, one past the end per bucket
+		std::vector<uint32_t> items; // Point indices grouped by bucket
+		size_t mask = 0;
+		[[nodiscard]] size_t bucketOf(const Cell& cell) const;
+};
+
+template <typename Visit>
+void SpatialHash::forEachNear(const size_t point, Visit&& visit) const {
+	const Cell center = this->cells[point];
+	const Vec3 p = (this->points[point] - this->origin) * this->toCell;
+	const float offsets[3] = {p.x - static_cast<float>(center.x), p.y - static_cast<float>(center.y), p.z - static_cast<float>(center.z)};
+	int32_t low[3], high[3];
+	for (int axis = 0; axis < 3; ++axis) {
+		low[axis] = offsets[axis] < this->reach ? -1 : 0;
+		high[axis] = offsets[axis] > 1.0f - this->reach ? 1 : 0;
+	}
+	for (int32_t dz = low[2]; dz <= high[2]; ++dz) {
+		for (int32_t dy = low[1]; dy <= high[1]; ++dy) {
+			for (int32_t dx = low[0]; dx <= high[0]; ++dx) {
+				const Cell cell{center.x + dx, center.y + dy, center.z + dz};
+				const size_t bucket = this->bucketOf(cell);
+				for (uint32_t i = this->bucketStart[bucket]; i < this->bucketStart[bucket + 1]; ++i) {
+					if (this->cells[this->items[i]] == cell) // Other cells can share the bucket
+						visit(this->items[i]);
+				}
+			}
+		}
+	}
+}
+
+#endif //SPATIALHASH_HPP
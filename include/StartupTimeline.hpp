@@ -0,0 +1,55 @@
+#ifndef STARTUPTIMELINE_HPP
+#define STARTUPTIMELINE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <initializer_list>
+#include "ansiCodes.hpp"
+
+#define TIMELINE_WIDTH 40 // Characters of the widest bar
+#define TIMELINE_LABEL 36 // Characters of the stage name column
+#define TIMELINE_SKIPPED SIZE_MAX // Handle of a stage begun once recording stopped, end ignores it
+
+// Records when each startup stage runs, from any thread, and prints them as a timeline once
+// the first frame can be drawn. Stages name the stages they wait for, which gives the
+// critical path: the chain of dependencies that finished last. Per file stages carry the file
+// as their scope, so meshes loading side by side keep their own durations and dependencies.
+// Nothing is recorded after printing or stop, reloads and benchmarks would grow it forever.
+class StartupTimeline {
+	public:
+		static StartupTimeline& getInstance();
+		StartupTimeline(const StartupTimeline&) = delete;
+		StartupTimeline& operator=(const StartupTimeline&) = delete;
+		void* operator new(size_t) = delete;
+		void operator delete(void*) = delete;
+		[[nodiscard]] size_t begin(const std::string& stage, std::initializer_list<const char*> dependencies = {},
+			const std::string& scope = "");
+		void end(size_t stage);
+		void print();
+		void stop(); // For runs that never print
+
+	private:
+		struct Stage {
+			std::string name;
+			std::string scope; // Dependencies resolve here first, then among stages without one
+			std::vector<std::string> dependencies;
+			double start = 0.0; // Milliseconds since the timeline was created
+			double end = -1.0;
+		};
+		std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+		std::mutex mutex;
+		std::vector<Stage> stages;
+		bool stopped = false; // Printed or stopped
+		[[nodiscard]] double now() const;
+		[[nodiscard]] const Stage* find(const std::string& stage, const std::string& scope) const;
+		StartupTimeline() = default;
+		~StartupTimeline() = default;
+};
+
+#endif //STARTUPTIMELINE_HPP
@@ -0,0 +1,60 @@
+#ifndef STREAMEDMESH_HPP
+#define STREAMEDMESH_HPP
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <sys/resource.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include "chunkFormat.hpp"
+#include "RenderState.hpp"
+#include "MappedFile.hpp"
+#include "ansiCodes.hpp"
+#include "exceptionTypes.hpp"
+
+#define STREAM_UPLOADS_PER_FRAME 4 // Clusters uploaded per frame, keeps the frame time bounded while paging in
+#define STREAM_PREFETCH 8 // Missing clusters whose pages are requested ahead of their upload
+
+// Draws a .smc file by keeping only the clusters the camera needs in GPU buffers. The file
+// is mapped read-only, every frame the clusters facing the eye are ranked by distance,
+// missing ones are uploaded nearest first and the least recently used ones are evicted to
+// stay under the budget. Mapped pages are released after each upload so the process never
+// holds more than the clusters in flight.
+class StreamedMesh {
+	public:
+		StreamedMesh(const std::string& path, size_t budget);
+		StreamedMesh(const StreamedMesh&) = delete;
+		StreamedMesh& operator=(const StreamedMesh&) = delete;
+		void update(const Vec3& eye, bool cullBackFacing); // Eye in the re-centered object space
+		void draw(RenderState& state, size_t instances) const; // Instance matrices are already bound
+		void printStats() const;
+		[[nodiscard]] const ChunkFileHeader& getHeader() const;
+
+	private:
+		struct Residency {
+			GLuint buffer = 0;
+			size_t lastUsed = 0; // Frame the cluster was last wanted in
+		};
+		MappedFile file;
+		ChunkFileHeader header{};
+		const ChunkCluster* clusters = nullptr;
+		std::vector<Residency> residency;
+		std::vector<size_t> wanted; // Clusters of the current frame, nearest first
+		std::vector<size_t> drawn; // Wanted clusters that are resident
+		size_t budget;
+		size_t residentBytes = 0;
+		size_t peakResidentBytes = 0;
+		size_t frame = 0;
+		size_t uploads = 0;
+		size_t evictions = 0;
+		size_t culled = 0;
+		void upload(size_t cluster);
+		void evict(size_t cluster);
+		bool makeRoom(size_t bytes);
+		[[nodiscard]] static size_t gpuBytes(const ChunkCluster& cluster);
+};
+
+#endif //STREAMEDMESH_HPP
@@ -0,0 +1,46 @@
+#ifndef TRANSFORMSTORE_HPP
+#define TRANSFORMSTORE_HPP
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include "matrix.hpp"
+#include "ansiCodes.hpp"
+
+#define TRANSFORM_BATCH 8 // Instances handled per kernel block, sized for one AVX register of floats
+
+// Per-instance transforms stored as structure of arrays. update() composes a shared affine
+// (typically view * object) with every cached instance matrix in fixed-width blocks that the
+// compiler can vectorize. Blocks whose instances are clean are skipped when the shared
+// transform did not change either.
+class TransformStore {
+	public:
+		size_t add(const Vec3& position, const Quat& rotation = Quat(), float scale = 1.0f);
+		void clear();
+		void setPosition(size_t index, const Vec3& position);
+		void setRotation(size_t index, const Quat& rotation);
+		void setScale(size_t index, float scale);
+		void update(const Affine& shared);
+		void printStats() const;
+		[[nodiscard]] size_t size() const;
+		[[nodiscard]] const std::vector<Mat4>& getModelViews() const;
+
+	private:
+		size_t count = 0;
+		std::vector<float> posX, posY, posZ;
+		std::vector<float> rotX, rotY, rotZ, rotW;
+		std::vector<float> scale;
+		std::vector<float> model[12]; // Cached instance matrices, one array per Affine component
+		std::vector<unsigned char> dirty;
+		std::vector<Mat4> modelViews;
+		Affine lastShared;
+		bool sharedValid = false;
+		size_t matricesComputed = 0;
+		size_t blocksSkipped = 0;
+		double kernelSeconds = 0.0;
+		void grow();
+		void updateModelBlock(size_t base);
+		void composeBlock(size_t base, const Affine& shared);
+};
+
+#endif //TRANSFORMSTORE_HPP
@@ -6,11 +6,13 @@
 #include <GL/gl.h>
 #include <GL/glx.h>
 #include <string>
+#include <algorithm>
 #include <unordered_map>
 #include <functional>
-#include "ObjectData.hpp"
+#include "Scene.hpp"
 #include "matrix.hpp"
 #include "FrameTimer.hpp"
+#include "FrameCapture.hpp"
 
 class WindowManager {
 public:
@@ -21,6 +23,8 @@ public:
 	void operator delete(void*) = delete;
 	void createWindow(const char *name = nullptr, const std::vector<int>& windowRes = std::vector<int>());
 	void exitProgram();
+	void takeScreenshot();
+	void toggleRecording();
 	void loop();
 
 private:
@@ -30,8 +34,7 @@ private:
 	XVisualInfo *visualInfo = nullptr;
 	Colormap colormap{};
 	Mat4 projectionMatrix = Mat4::identity();
-	Mat4 viewMatrix = Mat4::identity();
-	Mat4 modelMatrix = Mat4::identity();
+	Affine viewMatrix = Affine::identity();
 	float rotationAngle = 0.0f; // For rotation animation
 	long wmDelete = None;
 	bool running = false;
@@ -39,10 +42,12 @@ private:
 	std::string name;
 	std::vector<int> resolution;
 	std::unordered_map<KeySym, std::function<void()>> keyActions;
+	FrameCapture capture;
 	void resolveName(const char *name);
 	void resolveResolution(const std::vector<int>& windowRes);
 	Vec3 computeEye();
 	void updateProjectionMatrix();
+	void pick(int x, int y);
 	void render();
 	WindowManager() = default; 
 	~WindowManager();
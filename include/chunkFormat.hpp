@@ -0,0 +1,39 @@
+#ifndef CHUNKFORMAT_HPP
+#define CHUNKFORMAT_HPP
+
+#include <cstdint>
+#include "vertexFormat.hpp"
+#include "cluster.hpp"
+
+// Layout of a .smc (scop mesh chunks) file: header, cluster table, then one page-aligned block
+// per cluster holding its corners as PackedVertex followed by its planar PackedTexCoord.
+
+#define CHUNK_MAGIC "SCOPSMC1"
+#define CHUNK_ALIGNMENT 4096 // Cluster blocks start on a page so they can be released one by one
+#define CHUNK_TRIANGLES 16384 // Triangles per streamed cluster
+
+struct ChunkFileHeader {
+	char magic[8];
+	uint64_t vertexCount; // Global counts and indices are 64-bit, only cluster-local data is small
+	uint64_t triangleCount;
+	uint64_t clusterCount;
+	float positionScale[3]; // Same dequantization rule as VertexQuantization
+	float positionOffset[3];
+	float texCoordTransform[4];
+	float center[3]; // Centroid removed from every position
+	float radius;
+};
+
+struct ChunkCluster {
+	uint64_t offset; // Byte offset of the cluster block
+	uint32_t triangleCount;
+	uint32_t padding;
+	ClusterBounds bounds;
+};
+
+inline size_t chunkBlockSize(const uint32_t triangleCount) {
+	const size_t bytes = static_cast<size_t>(triangleCount) * 3 * (sizeof(PackedVertex) + sizeof(PackedTexCoord));
+	return (bytes + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT;
+}
+
+#endif //CHUNKFORMAT_HPP
@@ -0,0 +1,97 @@
+#ifndef CLUSTER_HPP
+#define CLUSTER_HPP
+
+#include <cmath>
+#include <algorithm>
+#include "matrix.hpp"
+
+// Bounding sphere and normal cone of a group of triangles, in object space.
+struct ClusterBounds {
+	Vec3 center;
+	float radius = 0.0f;
+	Vec3 coneAxis; // Average facing direction
+	float coneCutoff = 2.0f; // Sine of the cone half-angle, above 1 when the cone can never be back-facing
+};
+
+// corners holds three positions per triangle.
+inline ClusterBounds computeClusterBounds(const Vec3* corners, const size_t triangleCount) {
+	ClusterBounds bounds;
+	Vec3 min(+INFINITY, +INFINITY, +INFINITY), max(-INFINITY, -INFINITY, -INFINITY);
+	Vec3 normalSum;
+	for (size_t i = 0; i < triangleCount * 3; ++i) {
+		min = Vec3(std::min(min.x, corners[i].x), std::min(min.y, corners[i].y), std::min(min.z, corners[i].z));
+		max = Vec3(std::max(max.x, corners[i].x), std::max(max.y, corners[i].y), std::max(max.z, corners[i].z));
+	}
+	bounds.center = (min + max) * 0.5f;
+	for (size_t i = 0; i < triangleCount * 3; ++i)
+		bounds.radius = std::max(bounds.radius, (corners[i] - bounds.center).length());
+	for (size_t t = 0; t < triangleCount; ++t) {
+		const Vec3* c = corners + t * 3;
+		normalSum += Vec3::normalize(Vec3::cross(c[1] - c[0], c[2] - c[0]));
+	}
+	bounds.coneAxis = Vec3::normalize(normalSum);
+	float minDot = 1.0f;
+	for (size_t t = 0; t < triangleCount; ++t) {
+		const Vec3* c = corners + t * 3;
+		const Vec3 normal = Vec3::normalize(Vec3::cross(c[1] - c[0], c[2] - c[0]));
+		if (normal.length() > 0.0f) // Degenerate triangles have no facing and are ignored
+			minDot = std::min(minDot, Vec3::dot(normal, bounds.coneAxis));
+	}
+	if (bounds.coneAxis.length() > 0.0f && minDot > 0.0f)
+		bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+	return bounds;
+}
+
+// True when every triangle of the cluster faces away from an eye given in object space.
+inline bool isBackFacing(const ClusterBounds& bounds, const Vec3& eye) {
+	if (bounds.coneCutoff > 1.0f)
+		return false;
+	const Vec3 toCenter = bounds.center - eye;
+	const float distance = toCenter.length();
+	if (distance <= bounds.radius)
+		return false; // The eye is inside the sphere, every direction is possible
+	return Vec3::dot(toCenter, bounds.coneAxis) >= bounds.coneCutoff * distance + bounds.radius;
+}
+
+// Planes as (a, b, c, d) with a unit normal pointing inside, in the space of the matrix they
+// were extracted from.
+struct Frustum {
+	float planes[6][4];
+};
+
+// Gribb-Hartmann extraction from a column-major projection * modelView, giving object space planes.
+inline Frustum extractFrustum(const Mat4& clip) {
+	const float* m = clip.data();
+	Frustum frustum{};
+	for (int i = 0; i < 6; ++i) {
+		const int row = i / 2;
+		const float sign = i % 2 == 0 ? 1.0f : -1.0f; // Left, right, bottom, top, near, far
+		float* plane = frustum.planes[i];
+		for (int c = 0; c < 4; ++c)
+			plane[c] = m[c * 4 + 3] + sign * m[c * 4 + row];
+		const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		for (int c = 0; c < 4; ++c)
+			plane[c] /= length;
+	}
+	return frustum;
+}
+
+enum FrustumTest {
+	OUTSIDE = -1,
+	INTERSECTING,
+	INSIDE
+};
+
+inline FrustumTest testSphere(const Frustum& frustum, const Vec3& center, const float radius) {
+	FrustumTest result = INSIDE;
+	for (const auto& plane : frustum.planes) {
+		const float distance = plane[0] * center.x + plane[1] * center.y + plane[2] * center.z + plane[3];
+		if (distance < -radius)
+			return OUTSIDE;
+		if (distance < radius)
+			result = INTERSECTING;
+	}
+	return result;
+}
+
+#endif //CLUSTER_HPP
@@ -0,0 +1,57 @@
+#ifndef CONTENTHASH_HPP
+#define CONTENTHASH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "parallel.hpp"
+
+#define HASH_BLOCK (1 << 20) // Bytes hashed per job, fixed so the result does not depend on the thread count
+
+static constexpr uint64_t HASH_PRIME_1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t HASH_PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+
+inline uint64_t hashMix(uint64_t hash, const uint64_t word) {
+	hash ^= word * HASH_PRIME_2;
+	hash = (hash << 31) | (hash >> 33);
+	return hash * HASH_PRIME_1;
+}
+
+// Eight bytes per step, the tail is zero padded. Only tells buffers apart, not for untrusted input.
+inline uint64_t hashBlock(const unsigned char* data, const size_t size) {
+	uint64_t hash = HASH_PRIME_1 ^ size;
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, data + i, 8);
+		hash = hashMix(hash, word);
+	}
+	if (i < size) {
+		uint64_t word = 0;
+		std::memcpy(&word, data + i, size - i);
+		hash = hashMix(hash, word);
+	}
+	return hash;
+}
+
+// Blocks are hashed across the job system, then folded in order.
+inline uint64_t hashBytes(const void* data, const size_t size) {
+	const auto* bytes = static_cast<const unsigned char*>(data);
+	const size_t blocks = (size + HASH_BLOCK - 1) / HASH_BLOCK;
+	std::vector<uint64_t> partial(blocks);
+	parallelFor(blocks, 1, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t block = begin; block < end; ++block)
+			partial[block] = hashBlock(bytes + block * HASH_BLOCK, std::min<size_t>(HASH_BLOCK, size - block * HASH_BLOCK));
+	});
+	uint64_t hash = HASH_PRIME_2 ^ size;
+	for (const uint64_t value : partial)
+		hash = hashMix(hash, value);
+	return hash;
+}
+
+template <typename T>
+uint64_t hashVector(const std::vector<T>& values) {
+	return hashBytes(values.data(), values.size() * sizeof(T));
+}
+
+#endif //CONTENTHASH_HPP
@@ -3,6 +3,7 @@
 
 #include <exception>
 #include <string>
+#include <atomic>
 
 enum errorType {
   	NO_ERROR,				    //0
@@ -13,10 +14,13 @@ enum errorType {
 	UNABLE_TO_OPEN_OBJ_ERROR,	//5
 	UNABLE_TO_OPEN_PPM_ERROR,	//6
 	WRONG_PPM_ERROR,			//7
-	RUNTIME_ERROR				//8
+	RUNTIME_ERROR,				//8
+	INVALID_OPTION_ERROR		//9
 };
 
-extern errorType errorCode;
+#define USAGE "USAGE: ./scop [--budget MB] [--strict] [--quiet] [--instances N] [--no-share] file.obj|file.smc...\n       ./scop --chunk file.obj...\n       ./scop --batch [--strict] file.obj|directory..."
+
+extern std::atomic<errorType> errorCode; // Exceptions set it from whichever thread throws them
 
 class BaseException : public std::exception {
 	protected:
@@ -28,21 +32,21 @@ class BaseException : public std::exception {
 
 class NoArgException final : public BaseException {
 	public: 
-   		NoArgException() : BaseException("ERROR: Insert a .obj file name to load\nUSAGE: ./scop file.obj") {
+   		NoArgException() : BaseException("ERROR: Insert a .obj file name to load\n" USAGE) {
           		errorCode = NO_ARG_ERROR;
    		}
 };
 
 class TooManyArgException final : public BaseException {
 	public: 
-		TooManyArgException() : BaseException("ERROR: Too many arguments\nUSAGE: ./scop file.obj") {
+		TooManyArgException() : BaseException("ERROR: Too many arguments\n" USAGE) {
                 		errorCode = TOO_MANY_ARG_ERROR;
 		}
 };
 
 class WrongExtensionException final : public BaseException {
 	public: 
-		WrongExtensionException() : BaseException("ERROR: Wrong file extension\nUSAGE: ./scop file.obj") {
+		WrongExtensionException() : BaseException("ERROR: Wrong file extension\n" USAGE) {
 						errorCode = WRONG_EXTENSION_ERROR;
 		}
 };
@@ -69,6 +73,13 @@ class WrongPPMFormatException final : public BaseException
 		}
 };
 
+class InvalidOptionException final : public BaseException {
+	public:
+		explicit InvalidOptionException(const std::string &option) : BaseException("ERROR: Invalid option \"" + option + "\"\n" USAGE) {
+			errorCode = INVALID_OPTION_ERROR;
+		}
+};
+
 class RuntimeException final : public BaseException {
 	public:
 		explicit RuntimeException(const std::string &message) : BaseException(message) {
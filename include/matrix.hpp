@@ -3,44 +3,303 @@
 
 #include <cmath>
 
+// Header-only math types. Everything that does not need trigonometry or a square
+// root is constexpr so constant matrices are folded at compile time.
+
 class Vec2 {
 	public:
 		float u, v;
-		Vec2() : u(0.0f), v(0.0f) {}
-		Vec2(const float u, const float v) : u(u), v(v) {}
+		constexpr Vec2() : u(0.0f), v(0.0f) {}
+		constexpr Vec2(const float u, const float v) : u(u), v(v) {}
 };
 
 class Vec3 {
 	public:
 		float x, y, z;
-        Vec3() : x(0.0f), y(0.0f), z(0.0f) {}
-		Vec3(const float x, const float y, const float z) : x(x), y(y), z(z) {}
-		Vec3 operator+(const Vec3& rhs) const;
-		Vec3 operator-(const Vec3& rhs) const;
-		Vec3 operator*(float rhs) const;
-		Vec3& operator+=(const Vec3& rhs);
-		Vec3& operator/=(float rhs);
-		[[nodiscard]] static Vec3 cross(const Vec3& a, const Vec3& b);
+		constexpr Vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+		constexpr Vec3(const float x, const float y, const float z) : x(x), y(y), z(z) {}
+		constexpr Vec3 operator+(const Vec3& rhs) const;
+		constexpr Vec3 operator-(const Vec3& rhs) const;
+		constexpr Vec3 operator-() const;
+		constexpr Vec3 operator*(float rhs) const;
+		constexpr Vec3& operator+=(const Vec3& rhs);
+		constexpr Vec3& operator/=(float rhs);
+		[[nodiscard]] static constexpr Vec3 cross(const Vec3& a, const Vec3& b);
 		static Vec3 normalize(const Vec3& v);
-		static float dot(const Vec3& a, const Vec3& b);
+		static constexpr float dot(const Vec3& a, const Vec3& b);
 		[[nodiscard]] float length() const;
 };
 
 class Mat4 {
 	public:
-		explicit Mat4(const float[16]);
-		static Mat4 identity();
+		explicit constexpr Mat4(const float[16]);
+		static constexpr Mat4 identity();
 		static Mat4 perspective(float fov, float aspect, float near, float far); // FOV in angles, converted in radians internally
 		static Mat4 rotateY(float angle);
-		static Mat4 translate(const Vec3 &t);
+		static constexpr Mat4 translate(const Vec3 &t);
 		static Mat4 lookAt(const Vec3 &eye, const Vec3 &center, const Vec3 &up);
-		Mat4 operator*(const Mat4& other) const;
-		[[nodiscard]] const float* data() const;
+		constexpr Mat4 operator*(const Mat4& other) const;
+		[[nodiscard]] constexpr const float* data() const;
 
 	private:
 		float m[16]{};
-	
-		Mat4() = default; 
+
+		constexpr Mat4() = default;
+		friend class Affine;
+};
+
+class Quat {
+	public:
+		float x, y, z, w;
+		constexpr Quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+		constexpr Quat(const float x, const float y, const float z, const float w) : x(x), y(y), z(z), w(w) {}
+		static Quat fromAxisAngle(const Vec3& axis, float angle); // Axis must be normalized
+		static Quat rotateY(float angle); // Same handedness as Mat4::rotateY
+		constexpr Quat operator*(const Quat& rhs) const;
+		[[nodiscard]] constexpr Vec3 rotate(const Vec3& v) const;
+		static Quat normalize(const Quat& q);
+};
+
+// Affine transform stored as a column-major 3x4 matrix, the last row is implicitly (0, 0, 0, 1).
+// Composing two of them costs 36 multiplies instead of the 64 of a generic Mat4 product.
+class Affine {
+	public:
+		Vec3 col[3]; // Linear part (rotation and scale)
+		Vec3 t; // Translation
+		constexpr Affine() : col{{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}, t() {}
+		static constexpr Affine identity();
+		static constexpr Affine translate(const Vec3& t);
+		static constexpr Affine fromTRS(const Vec3& t, const Quat& r, float scale = 1.0f);
+		static Affine lookAt(const Vec3& eye, const Vec3& center, const Vec3& up);
+		constexpr Affine operator*(const Affine& rhs) const;
+		[[nodiscard]] constexpr Vec3 transformPoint(const Vec3& p) const;
+		[[nodiscard]] constexpr Vec3 transformVector(const Vec3& v) const;
+		[[nodiscard]] constexpr Mat4 toMat4() const;
 };
 
+constexpr Vec3 Vec3::cross(const Vec3 &a, const Vec3 &b) {
+	return {
+		a.y * b.z - a.z * b.y,
+		a.z * b.x - a.x * b.z,
+		a.x * b.y - a.y * b.x
+	};
+}
+
+inline Vec3 Vec3::normalize(const Vec3 &v) {
+	const float length = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+	if (length == 0.0f) {
+		return {0, 0, 0}; // Avoid division by zero
+	}
+	return {v.x / length, v.y / length, v.z / length};
+}
+
+constexpr float Vec3::dot(const Vec3 &a, const Vec3 &b) {
+	return (a.x * b.x + a.y * b.y + a.z * b.z);
+}
+
+inline float Vec3::length() const {
+	return sqrtf(this->x * this->x + this->y * this->y + this->z * this->z);
+}
+
+constexpr Vec3 Vec3::operator+(const Vec3& rhs) const {
+	return {this->x + rhs.x, this->y + rhs.y, this->z + rhs.z};
+}
+
+constexpr Vec3 Vec3::operator-(const Vec3& rhs) const {
+	return {this->x - rhs.x, this->y - rhs.y, this->z - rhs.z};
+}
+
+constexpr Vec3 Vec3::operator-() const {
+	return {-this->x, -this->y, -this->z};
+}
+
+constexpr Vec3 Vec3::operator*(const float rhs) const {
+	return {this->x * rhs, this->y * rhs, this->z * rhs};
+}
+
+constexpr Vec3& Vec3::operator+=(const Vec3& rhs) {
+	this->x += rhs.x;
+	this->y += rhs.y;
+	this->z += rhs.z;
+	return *this;
+}
+
+constexpr Vec3 &Vec3::operator/=(const float rhs) {
+	if (rhs == 0.0f) {
+		return *this;	// Avoid division by zero
+	}
+	this->x /= rhs;
+	this->y /= rhs;
+	this->z /= rhs;
+	return *this;
+}
+
+
+constexpr Mat4 Mat4::identity() {
+	Mat4 identity;
+	identity.m[0] = 1.0f;
+	identity.m[5] = 1.0f;
+	identity.m[10] = 1.0f;
+	identity.m[15] = 1.0f;
+	return identity;
+}
+
+inline Mat4 Mat4::perspective(float fov, const float aspect, const float near, const float far) {
+	fov *= M_PI / 180.0f; // Convert FOV from degrees to radians
+	const float f = 1.0f / tanf(fov / 2.0f);
+	const float nf = 1.0f / (far - near);
+
+	Mat4 perspective;
+	perspective.m[0] = f / aspect;
+	perspective.m[5] = f;
+	perspective.m[10] = -(far + near) * nf;
+	perspective.m[11] = -1.0f;
+	perspective.m[14] = -(2 * far * near) * nf;
+	return perspective;
+}
+
+inline Mat4 Mat4::rotateY(const float angle) {
+	const float c = cosf(angle);
+	const float s = sinf(angle);
+
+	Mat4 rotationY = identity();
+	rotationY.m[0] = c;
+	rotationY.m[2] = s;
+	rotationY.m[8] = -s;
+	rotationY.m[10] = c;
+	return rotationY;
+}
+
+constexpr Mat4 Mat4::translate(const Vec3 &t) {
+	Mat4 translate = identity();
+	translate.m[12] = t.x;
+	translate.m[13] = t.y;
+	translate.m[14] = t.z;
+	return translate;
+}
+
+inline Mat4 Mat4::lookAt(const Vec3 &eye, const Vec3 &center, const Vec3 &up) {
+	return Affine::lookAt(eye, center, up).toMat4();
+}
+
+constexpr Mat4 Mat4::operator*(const Mat4& other) const {
+	Mat4 result;
+	for (int row = 0; row < 4; ++row) {
+		for (int col = 0; col < 4; ++col) {
+			for (int k = 0; k < 4; ++k) {
+				result.m[col * 4 + row] += this->m[k * 4 + row] * other.m[col * 4 + k];
+			}
+		}
+	}
+	return result;
+}
+
+constexpr const float *Mat4::data() const {
+	return m;
+}
+
+constexpr Mat4::Mat4(const float value[16]) {
+	for (int i = 0; i < 16; i++)
+		m[i] = value[i];
+}
+
+
+inline Quat Quat::fromAxisAngle(const Vec3& axis, const float angle) {
+	const float s = sinf(angle * 0.5f);
+	return {axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f)};
+}
+
+inline Quat Quat::rotateY(const float angle) {
+	return fromAxisAngle(Vec3(0.0f, -1.0f, 0.0f), angle); // Mat4::rotateY turns +X towards +Z
+}
+
+constexpr Quat Quat::operator*(const Quat& rhs) const {
+	return {
+		this->w * rhs.x + this->x * rhs.w + this->y * rhs.z - this->z * rhs.y,
+		this->w * rhs.y - this->x * rhs.z + this->y * rhs.w + this->z * rhs.x,
+		this->w * rhs.z + this->x * rhs.y - this->y * rhs.x + this->z * rhs.w,
+		this->w * rhs.w - this->x * rhs.x - this->y * rhs.y - this->z * rhs.z
+	};
+}
+
+constexpr Vec3 Quat::rotate(const Vec3& v) const {
+	const Vec3 q(this->x, this->y, this->z);
+	const Vec3 t = Vec3::cross(q, v) * 2.0f;
+	return v + t * this->w + Vec3::cross(q, t);
+}
+
+inline Quat Quat::normalize(const Quat& q) {
+	const float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+	if (length == 0.0f) {
+		return {}; // Fall back to the identity rotation
+	}
+	return {q.x / length, q.y / length, q.z / length, q.w / length};
+}
+
+
+constexpr Affine Affine::identity() {
+	return {};
+}
+
+constexpr Affine Affine::translate(const Vec3& t) {
+	Affine translate;
+	translate.t = t;
+	return translate;
+}
+
+constexpr Affine Affine::fromTRS(const Vec3& t, const Quat& r, const float scale) {
+	const float xx = r.x * r.x, yy = r.y * r.y, zz = r.z * r.z;
+	const float xy = r.x * r.y, xz = r.x * r.z, yz = r.y * r.z;
+	const float wx = r.w * r.x, wy = r.w * r.y, wz = r.w * r.z;
+
+	Affine trs;
+	trs.col[0] = Vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy)) * scale;
+	trs.col[1] = Vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx)) * scale;
+	trs.col[2] = Vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)) * scale;
+	trs.t = t;
+	return trs;
+}
+
+inline Affine Affine::lookAt(const Vec3& eye, const Vec3& center, const Vec3& up) {
+	const Vec3 f = Vec3::normalize(center - eye);
+	const Vec3 s = Vec3::normalize(Vec3::cross(f, up));
+	const Vec3 u = Vec3::cross(s, f);
+
+	Affine lookAt;
+	lookAt.col[0] = Vec3(s.x, u.x, -f.x);
+	lookAt.col[1] = Vec3(s.y, u.y, -f.y);
+	lookAt.col[2] = Vec3(s.z, u.z, -f.z);
+	lookAt.t = Vec3(-Vec3::dot(s, eye), -Vec3::dot(u, eye), Vec3::dot(f, eye));
+	return lookAt;
+}
+
+constexpr Affine Affine::operator*(const Affine& rhs) const {
+	Affine result;
+	result.col[0] = this->transformVector(rhs.col[0]);
+	result.col[1] = this->transformVector(rhs.col[1]);
+	result.col[2] = this->transformVector(rhs.col[2]);
+	result.t = this->transformPoint(rhs.t);
+	return result;
+}
+
+constexpr Vec3 Affine::transformVector(const Vec3& v) const {
+	return this->col[0] * v.x + this->col[1] * v.y + this->col[2] * v.z;
+}
+
+constexpr Vec3 Affine::transformPoint(const Vec3& p) const {
+	return this->transformVector(p) + this->t;
+}
+
+constexpr Mat4 Affine::toMat4() const {
+	Mat4 result;
+	const Vec3* columns[4] = {&this->col[0], &this->col[1], &this->col[2], &this->t};
+	for (int i = 0; i < 4; ++i) {
+		result.m[i * 4] = columns[i]->x;
+		result.m[i * 4 + 1] = columns[i]->y;
+		result.m[i * 4 + 2] = columns[i]->z;
+	}
+	result.m[15] = 1.0f;
+	return result;
+}
+
 #endif //VECTORS_HPP
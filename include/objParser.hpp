@@ -0,0 +1,76 @@
+#ifndef OBJPARSER_HPP
+#define OBJPARSER_HPP
+
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <memory_resource>
+#include <vector>
+#include <algorithm>
+
+// Allocation-free helpers shared by every OBJ reader.
+
+inline std::string_view nextToken(std::string_view& rest) {
+	const size_t start = rest.find_first_not_of(" \t\r");
+	if (start == std::string_view::npos) {
+		rest = std::string_view();
+		return rest;
+	}
+	const size_t end = std::min(rest.find_first_of(" \t\r", start), rest.size());
+	const std::string_view token = rest.substr(start, end - start);
+	rest.remove_prefix(end);
+	return token;
+}
+
+inline bool parseFloat(std::string_view& rest, float& value) { // False and 0 for a missing or malformed token
+	const std::string_view token = nextToken(rest);
+	value = 0.0f;
+	return std::from_chars(token.data(), token.data() + token.size(), value).ec == std::errc();
+}
+
+inline float parseFloat(std::string_view& rest) {
+	float value; // Missing or malformed coordinates read as 0
+	parseFloat(rest, value);
+	return value;
+}
+
+// Reads the file in fixed-size chunks and calls onBlock with every run of whole lines, newlines
+// included. The partial tail of a chunk moves to the front, the buffer doubles if one line
+// outgrows it.
+template <typename OnBlock>
+void forEachBlock(std::ifstream& file, std::pmr::vector<char>& buffer, OnBlock&& onBlock) {
+	size_t filled = 0;
+	while (file) {
+		file.read(buffer.data() + filled, static_cast<std::streamsize>(buffer.size() - filled));
+		filled += static_cast<size_t>(file.gcount());
+		const std::string_view data(buffer.data(), filled);
+		const size_t lastNewline = data.rfind('\n');
+		const size_t whole = lastNewline == std::string_view::npos ? 0 : lastNewline + 1;
+		if (whole > 0)
+			onBlock(data.substr(0, whole));
+		filled -= whole;
+		std::memmove(buffer.data(), buffer.data() + whole, filled);
+		if (filled == buffer.size())
+			buffer.resize(buffer.size() * 2);
+	}
+	if (filled > 0)
+		onBlock(std::string_view(buffer.data(), filled)); // Last line without a newline
+}
+
+// Calls onLine for every line of a block, without its newline.
+template <typename OnLine>
+void forEachLineOf(std::string_view block, OnLine&& onLine) {
+	while (!block.empty()) {
+		const size_t newline = std::min(block.find('\n'), block.size());
+		onLine(block.substr(0, newline));
+		block.remove_prefix(std::min(newline + 1, block.size()));
+	}
+}
+
+template <typename OnLine>
+void forEachLine(std::ifstream& file, std::pmr::vector<char>& buffer, OnLine&& onLine) {
+	forEachBlock(file, buffer, [&](const std::string_view block) { forEachLineOf(block, onLine); });
+}
+
+#endif //OBJPARSER_HPP
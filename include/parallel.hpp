@@ -0,0 +1,48 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include "JobSystem.hpp"
+
+#define SIMD_LANES 8 // Accumulators per reduction, wide enough for one AVX register of floats
+
+// Number of contiguous chunks parallelFor will split [0, count) into. Chunks never get
+// smaller than minChunk so small inputs stay on the calling thread.
+inline size_t parallelChunkCount(const size_t count, const size_t minChunk) {
+	return JobSystem::getInstance().chunkCount(count, minChunk);
+}
+
+// Calls function(begin, end, chunk) once per chunk on the job system workers.
+template <typename Function>
+void parallelFor(const size_t count, const size_t minChunk, Function&& function) {
+	JobSystem::getInstance().parallelFor(count, minChunk, std::forward<Function>(function));
+}
+
+// Sorts the parallelFor chunks as jobs, then merges neighbouring runs pairwise in rounds of
+// parallel merges. Equal elements keep no particular order, like std::sort.
+template <typename T, typename Compare = std::less<T>>
+void parallelSort(std::vector<T>& values, const size_t minChunk, Compare compare = Compare()) {
+	const size_t count = values.size();
+	const size_t chunks = parallelChunkCount(count, minChunk);
+	if (chunks == 1) {
+		std::sort(values.begin(), values.end(), compare);
+		return;
+	}
+	const size_t step = (count + chunks - 1) / chunks; // Same split as parallelFor
+	parallelFor(count, minChunk, [&](const size_t begin, const size_t end, size_t) {
+		std::sort(values.begin() + begin, values.begin() + end, compare);
+	});
+	for (size_t width = step; width < count; width *= 2) {
+		parallelFor((count + 2 * width - 1) / (2 * width), 1, [&](const size_t begin, const size_t end, size_t) {
+			for (size_t pair = begin; pair < end; ++pair) {
+				const size_t first = pair * 2 * width;
+				std::inplace_merge(values.begin() + first, values.begin() + std::min(first + width, count),
+					values.begin() + std::min(first + 2 * width, count), compare);
+			}
+		});
+	}
+}
+
+#endif //PARALLEL_HPP
@@ -0,0 +1,52 @@
+#ifndef SHADERS_HPP
+#define SHADERS_HPP
+
+// GLSL 1.30 against the compatibility profile. The projection still comes from glLoadMatrixf,
+// the model-view is a vertex attribute so instanced draws can read one per instance.
+
+inline constexpr const char* MESH_VERTEX_SHADER = R"(#version 130
+in vec3 position; // Normalized to [-1, 1] over the AABB by the attribute fetch
+in vec2 texCoord; // Normalized to [-1, 1] over the UV range of the projection
+in float shade; // Only read from the provoking vertex, the last of each triangle
+in vec3 normal; // Object space, zero when the buffer carries none
+in mat4 modelView; // Rigid with uniform scale, so it also transforms normals
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+uniform vec4 texCoordTransform; // xy scale, zw offset
+out vec2 uv;
+flat out float grey;
+out vec3 eyePosition;
+out vec3 eyeNormal;
+
+void main() {
+	uv = texCoord * texCoordTransform.xy + texCoordTransform.zw;
+	grey = shade;
+	vec4 objectPosition = vec4(position * positionScale + positionOffset, 1.0);
+	eyePosition = (modelView * objectPosition).xyz;
+	eyeNormal = mat3(modelView) * normal;
+	gl_Position = gl_ProjectionMatrix * vec4(eyePosition, 1.0);
+}
+)";
+
+inline constexpr const char* MESH_FRAGMENT_SHADER = R"(#version 130
+in vec2 uv;
+flat in float grey;
+in vec3 eyePosition;
+in vec3 eyeNormal;
+uniform sampler2D tex;
+uniform float transition; // 0 shows the grey shades, 1 the texture
+uniform float lighting; // 0 shows the flat colors, 1 lights them
+const vec3 LIGHT = vec3(0.267, 0.535, 0.802); // Eye space, above and to the right of the camera
+
+void main() {
+	vec3 base = mix(vec3(grey), texture(tex, uv).rgb, transition);
+	vec3 n = dot(eyeNormal, eyeNormal) > 1e-6 ? normalize(eyeNormal)
+		: normalize(cross(dFdx(eyePosition), dFdy(eyePosition))); // Faceted for previews and streamed clusters
+	float diffuse = abs(dot(n, LIGHT)); // Both sides are drawn and some files wind inward
+	float specular = pow(abs(dot(n, normalize(LIGHT - normalize(eyePosition)))), 32.0) * 0.25;
+	vec3 lit = base * (0.2 + 0.8 * diffuse) + vec3(specular);
+	gl_FragColor = vec4(mix(base, lit, lighting), 1.0);
+}
+)";
+
+#endif //SHADERS_HPP
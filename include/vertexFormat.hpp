@@ -0,0 +1,93 @@
+#ifndef VERTEXFORMAT_HPP
+#define VERTEXFORMAT_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "matrix.hpp"
+
+enum TextureProjection {
+	PLANAR,
+	CYLINDRICAL,
+	SPHERICAL,
+	BOX,
+	PROJECTION_COUNT
+};
+
+enum VertexAttribLocation {
+	ATTRIB_POSITION, // Location 0 so the attribute provokes the vertex in the compatibility profile
+	ATTRIB_TEXCOORD,
+	ATTRIB_SHADE,
+	ATTRIB_NORMAL,
+	ATTRIB_MODELVIEW // Four locations, one per matrix column
+};
+
+struct PackedVertex {
+	int16_t position[3]; // Signed normalized over the AABB, dequantized by the GL attribute fetch
+	uint8_t shade; // Unsigned normalized grey
+	uint8_t padding;
+};
+
+struct PackedTexCoord {
+	int16_t u, v; // Signed normalized over the UV range of one projection
+};
+
+struct PackedNormal {
+	int8_t normal[3]; // Signed normalized unit vector
+	int8_t padding; // Keeps every normal 4-byte aligned for the attribute fetch
+};
+
+// A resident corner streams all three, a .smc corner has no normal buffer and costs 12 bytes.
+// The normal keeps its own 4 bytes: the one spare byte of PackedVertex is too few for it.
+static_assert(sizeof(PackedVertex) + sizeof(PackedTexCoord) <= 12, "Streamed vertex must fit in 12 bytes");
+static_assert(sizeof(PackedVertex) + sizeof(PackedTexCoord) + sizeof(PackedNormal) <= 16, "Drawn vertex must fit in 16 bytes");
+
+inline int16_t quantizeSnorm(const float value) {
+	return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+inline PackedNormal packNormal(const Vec3& normal) {
+	PackedNormal packed{};
+	const float components[3] = {normal.x, normal.y, normal.z};
+	for (int axis = 0; axis < 3; ++axis)
+		packed.normal[axis] = static_cast<int8_t>(std::lround(std::clamp(components[axis], -1.0f, 1.0f) * 127.0f));
+	return packed;
+}
+
+inline float dequantizeSnorm(const int16_t value) {
+	return std::max(static_cast<float>(value) / 32767.0f, -1.0f); // GL 4.2 rule, older drivers differ by under one step
+}
+
+inline uint8_t shadeOf(const uint64_t triangle) {
+	return static_cast<uint8_t>(std::lround(static_cast<float>(triangle % 10) / 10.0f * 255.0f)); // Banded greys
+}
+
+struct ProjectionSetup {
+	float min[3];
+	float invRange[3];
+	float scale; // Planar texel density, one repeat per unit along the longest of Y and Z
+	float repeats; // Tiling of the wrapped projections
+	float cosAngle, sinAngle; // Planar UVs are turned a quarter turn so the texture stands upright
+};
+
+inline ProjectionSetup makeProjectionSetup(const float min[3], const float max[3]) {
+	constexpr float angle = -M_PI / 2.0f;
+	ProjectionSetup setup{};
+	for (int axis = 0; axis < 3; ++axis) {
+		setup.min[axis] = min[axis];
+		setup.invRange[axis] = 1.0f / (max[axis] - min[axis]);
+	}
+	setup.scale = std::max(max[1] - min[1], max[2] - min[2]);
+	setup.repeats = std::max(1.0f, std::round(setup.scale));
+	setup.cosAngle = std::cos(angle);
+	setup.sinAngle = std::sin(angle);
+	return setup;
+}
+
+inline Vec2 projectPlanar(const ProjectionSetup& p, const float y, const float z) {
+	const float u = (y - p.min[1]) * p.invRange[1] * p.scale - 0.5f;
+	const float v = (z - p.min[2]) * p.invRange[2] * p.scale - 0.5f;
+	return {u * p.cosAngle - v * p.sinAngle + 0.5f, u * p.sinAngle + v * p.cosAngle + 0.5f};
+}
+
+#endif //VERTEXFORMAT_HPP
@@ -0,0 +1,124 @@
+#include "BatchRunner.hpp"
+
+static std::string jsonString(const std::string& text) {
+	std::string out = "\"";
+	for (const char c : text) {
+		if (c == '"' || c == '\\')
+			out += std::string("\\") + c;
+		else if (static_cast<unsigned char>(c) < 0x20) {
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			out += escaped;
+		}
+		else
+			out += c;
+	}
+	return out + "\"";
+}
+
+static std::string jsonVec3(const Vec3& v) {
+	std::ostringstream out;
+	out << std::setprecision(9) << "[" << v.x << "," << v.y << "," << v.z << "]";
+	return out.str();
+}
+
+// Files are kept as given, directories contribute their .obj files in path order.
+BatchRunner::BatchRunner(const Options& options) : strict(options.strict) {
+	for (const std::string& path : options.paths) {
+		std::error_code error;
+		if (!std::filesystem::is_directory(path, error)) {
+			this->files.push_back(path);
+			continue;
+		}
+		std::vector<std::string> found;
+		const auto flags = std::filesystem::directory_options::skip_permission_denied;
+		for (auto it = std::filesystem::recursive_directory_iterator(path, flags, error);
+			it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+			if (error)
+				break;
+			if (it->is_regular_file(error) && it->path().extension() == ".obj")
+				found.push_back(it->path().string());
+		}
+		std::sort(found.begin(), found.end());
+		this->files.insert(this->files.end(), found.begin(), found.end());
+	}
+}
+
+void BatchRunner::run(const Options& options) {
+	BatchRunner runner(options);
+	const auto start = std::chrono::steady_clock::now();
+	const size_t threads = std::max<size_t>(std::min(JobSystem::getInstance().getThreadCount(), runner.files.size()), 1);
+	std::vector<std::thread> loaders;
+	for (size_t i = 0; i < threads; ++i)
+		loaders.emplace_back(&BatchRunner::worker, &runner);
+	for (std::thread& loader : loaders)
+		loader.join();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(3) << "{\"summary\":true,\"files\":" << runner.files.size() << ",\"failed\":" << runner.failed
+		<< ",\"warnings\":" << runner.warnings << ",\"bytes\":" << runner.bytes << ",\"threads\":" << threads << ",\"seconds\":" << seconds
+		<< ",\"mb_per_s\":" << static_cast<double>(runner.bytes) / (1 << 20) / std::max(seconds, 1e-9)
+		<< ",\"files_per_s\":" << static_cast<double>(runner.files.size()) / std::max(seconds, 1e-9) << "}";
+	std::cout << out.str() << std::endl;
+	errorCode = runner.failed > 0 ? RUNTIME_ERROR : NO_ERROR; // Set by whichever file failed last otherwise
+}
+
+void BatchRunner::worker() {
+	for (size_t i = this->next.fetch_add(1); i < this->files.size(); i = this->next.fetch_add(1)) {
+		bool ok = false;
+		uintmax_t size = 0;
+		size_t fileWarnings = 0;
+		const std::string line = this->process(this->files[i], ok, size, fileWarnings);
+		this->emit(line, ok, size, fileWarnings);
+	}
+}
+
+// Failures are reported with the first line of the error, the usage text that may follow is noise here.
+std::string BatchRunner::process(const std::string& path, bool& ok, uintmax_t& size, size_t& warnings) const {
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(3) << "{\"file\":" << jsonString(path);
+	std::error_code error;
+	size = std::filesystem::file_size(path, error);
+	if (error)
+		size = 0;
+	const auto start = std::chrono::steady_clock::now();
+	ObjectData mesh;
+	mesh.setHeadless(true);
+	mesh.setDiagnosticsMode(this->strict, true);
+	try {
+		mesh.load(path.c_str());
+		ok = true;
+	}
+	catch (const std::exception& e) {
+		const std::string message = e.what();
+		out << ",\"ok\":false,\"bytes\":" << size << ",\"error\":" << jsonString(message.substr(0, message.find('\n')));
+	}
+	const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	if (!ok) {
+		out << ",\"load_ms\":" << loadMs << "}";
+		return out.str();
+	}
+	const Diagnostics& diagnostics = mesh.getDiagnostics();
+	const RepairStats& repair = mesh.getRepairStats();
+	warnings = diagnostics.getTotal();
+	out << ",\"ok\":true,\"bytes\":" << size << ",\"vertices\":" << mesh.getVertexCount() << ",\"faces\":" << mesh.getTriangleCount()
+		<< ",\"bounds\":{\"min\":" << jsonVec3(mesh.getMin()) << ",\"max\":" << jsonVec3(mesh.getMax()) << "}"
+		<< ",\"warnings\":" << warnings << ",\"warning_counts\":{";
+	for (int c = 0; c < DIAGNOSTIC_CATEGORY_COUNT; ++c) {
+		const auto category = static_cast<DiagnosticCategory>(c);
+		out << (c == 0 ? "" : ",") << "\"" << Diagnostics::keyOf(category) << "\":" << diagnostics.getCount(category);
+	}
+	out << "},\"repair\":{\"welded\":" << repair.weldedVertices << ",\"degenerate\":" << repair.degenerateTriangles
+		<< ",\"duplicate\":" << repair.duplicateTriangles << "}"
+		<< ",\"parse_ms\":" << mesh.getLoadStats().parseMs << ",\"load_ms\":" << loadMs
+		<< ",\"mb_per_s\":" << static_cast<double>(size) / (1 << 20) / std::max(loadMs / 1000.0, 1e-9) << "}";
+	return out.str();
+}
+
+void BatchRunner::emit(const std::string& line, const bool ok, const uintmax_t size, const size_t warnings) {
+	const std::lock_guard<std::mutex> lock(this->outputMutex);
+	std::cout << line << std::endl; // Flushed so a long run can be followed with tail -f
+	this->failed += ok ? 0 : 1;
+	this->warnings += warnings;
+	this->bytes += size;
+}
@@ -0,0 +1,320 @@
+#include "Bvh.hpp"
+
+static float axisOf(const Vec3& v, const int axis) {
+	return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+
+static Vec3 minOf(const Vec3& a, const Vec3& b) {
+	return {std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z)};
+}
+
+static Vec3 maxOf(const Vec3& a, const Vec3& b) {
+	return {std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)};
+}
+
+static float halfArea(const Vec3& min, const Vec3& max) {
+	const Vec3 d = max - min;
+	return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+// Twice the box center, binning only compares ratios so the halving is skipped.
+static Vec3 centroidOf(const Vec3& min, const Vec3& max) {
+	return min + max;
+}
+
+static int binOf(const Vec3& min, const Vec3& max, const int axis, const float binMin, const float toBin) {
+	return std::min(BVH_BINS - 1, static_cast<int>((axisOf(min, axis) + axisOf(max, axis) - binMin) * toBin));
+}
+
+bool RayHit::found() const {
+	return this->triangle != UINT32_MAX;
+}
+
+void Bvh::build(const Vec3* vertices, const unsigned int* faces, const size_t count) {
+	const auto start = std::chrono::steady_clock::now();
+	this->clear();
+	if (count == 0)
+		return;
+	Build build;
+	build.items.resize(count);
+	parallelFor(count, BVH_TASK_TRIANGLES, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t t = begin; t < end; ++t) {
+			const Vec3& a = vertices[faces[t * 3]];
+			const Vec3& b = vertices[faces[t * 3 + 1]];
+			const Vec3& c = vertices[faces[t * 3 + 2]];
+			build.items[t] = {minOf(minOf(a, b), c), static_cast<uint32_t>(t), maxOf(maxOf(a, b), c), 0.0f};
+		}
+	});
+	this->nodes.resize(count * 2); // A binary tree over n leaves has at most 2n - 1 nodes, plus the empty slot
+	this->subdivide(build, 0, 0, static_cast<uint32_t>(count), 0);
+	this->nodes.resize(build.nodesUsed);
+	this->nodes.shrink_to_fit();
+
+	this->triangles.resize(count);
+	this->triangleIds.resize(count);
+	parallelFor(count, BVH_TASK_TRIANGLES, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t i = begin; i < end; ++i) {
+			const uint32_t id = build.items[i].id;
+			const unsigned int* corner = faces + static_cast<size_t>(id) * 3;
+			const Vec3& v0 = vertices[corner[0]];
+			this->triangles[i] = {v0, vertices[corner[1]] - v0, vertices[corner[2]] - v0};
+			this->triangleIds[i] = id;
+		}
+	});
+	this->view = {this->nodes.data(), this->nodes.size(), this->triangles.data(), this->triangleIds.data(), count, build.leaves, build.depth};
+	this->buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Bounds of the triangles and of their centroids over one range.
+void Bvh::fitNode(const Build& build, BvhNode& node, const uint32_t first, const uint32_t count, Vec3& centroidMin, Vec3& centroidMax) const {
+	const size_t chunks = count > BVH_PARALLEL_BINNING ? parallelChunkCount(count, BVH_TASK_TRIANGLES) : 1;
+	std::vector<Bin> boxes(chunks), centroids(chunks);
+	const auto fit = [&](const size_t begin, const size_t end, const size_t chunk) {
+		Bin box, centroid;
+		for (size_t i = first + begin; i < first + end; ++i) {
+			const BuildTriangle& item = build.items[i];
+			box.min = minOf(box.min, item.min);
+			box.max = maxOf(box.max, item.max);
+			const Vec3 centroid2 = centroidOf(item.min, item.max);
+			centroid.min = minOf(centroid.min, centroid2);
+			centroid.max = maxOf(centroid.max, centroid2);
+		}
+		boxes[chunk] = box;
+		centroids[chunk] = centroid;
+	};
+	if (chunks == 1)
+		fit(0, count, 0);
+	else
+		parallelFor(count, BVH_TASK_TRIANGLES, fit);
+	node.min = centroidMin = Vec3(+INFINITY, +INFINITY, +INFINITY);
+	node.max = centroidMax = Vec3(-INFINITY, -INFINITY, -INFINITY);
+	for (size_t chunk = 0; chunk < chunks; ++chunk) {
+		node.min = minOf(node.min, boxes[chunk].min);
+		node.max = maxOf(node.max, boxes[chunk].max);
+		centroidMin = minOf(centroidMin, centroids[chunk].min);
+		centroidMax = maxOf(centroidMax, centroids[chunk].max);
+	}
+}
+
+// Counts the triangles of a range into BVH_BINS slices of the centroid bounds along one axis.
+void Bvh::binRange(const Build& build, const uint32_t first, const uint32_t count, const int axis, const float binMin,
+	const float toBin, Bin (&bins)[BVH_BINS]) const {
+	const auto fill = [&build, first, axis, binMin, toBin](const size_t begin, const size_t end, Bin (&into)[BVH_BINS]) {
+		const BuildTriangle* item = build.items.data() + first + begin;
+		const BuildTriangle* last = build.items.data() + first + end;
+		for (; item != last; ++item) {
+			Bin& bin = into[binOf(item->min, item->max, axis, binMin, toBin)];
+			bin.min = minOf(bin.min, item->min);
+			bin.max = maxOf(bin.max, item->max);
+			bin.count++;
+		}
+	};
+	if (count <= BVH_PARALLEL_BINNING) {
+		fill(0, count, bins);
+		return;
+	}
+	struct Row {
+		Bin bins[BVH_BINS];
+	};
+	std::vector<Row> partial(parallelChunkCount(count, BVH_TASK_TRIANGLES));
+	parallelFor(count, BVH_TASK_TRIANGLES, [&](const size_t begin, const size_t end, const size_t chunk) {
+		fill(begin, end, partial[chunk].bins);
+	});
+	for (const Row& row : partial) {
+		for (int b = 0; b < BVH_BINS; ++b) {
+			bins[b].min = minOf(bins[b].min, row.bins[b].min);
+			bins[b].max = maxOf(bins[b].max, row.bins[b].max);
+			bins[b].count += row.bins[b].count;
+		}
+	}
+}
+
+// Bins along the widest centroid axis and splits at the cheapest bin boundary, or keeps a leaf
+// when intersecting every triangle costs less than traversing two children. Costs assume one
+// unit per triangle and per node visit.
+void Bvh::subdivide(Build& build, const uint32_t index, const uint32_t first, const uint32_t count, const size_t level) {
+	BvhNode& node = this->nodes[index];
+	Vec3 centroidMin, centroidMax;
+	this->fitNode(build, node, first, count, centroidMin, centroidMax);
+	size_t deepest = build.depth.load(std::memory_order_relaxed);
+	while (deepest < level && !build.depth.compare_exchange_weak(deepest, level, std::memory_order_relaxed))
+		;
+	const auto makeLeaf = [&] {
+		node.leftOrFirst = first;
+		node.triangleCount = count;
+		build.leaves.fetch_add(1, std::memory_order_relaxed);
+	};
+	const Vec3 extent = centroidMax - centroidMin;
+	const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+	if (count <= BVH_LEAF_TRIANGLES || level + 1 >= BVH_MAX_DEPTH || axisOf(extent, axis) <= 0.0f) {
+		makeLeaf(); // Identical centroids cannot be separated by binning
+		return;
+	}
+	const float binMin = axisOf(centroidMin, axis), toBin = BVH_BINS * 0.9999f / axisOf(extent, axis);
+	Bin bins[BVH_BINS];
+	this->binRange(build, first, count, axis, binMin, toBin, bins);
+
+	float leftCost[BVH_BINS]; // Cost of bins [0, b] on the left
+	Bin left;
+	for (int b = 0; b < BVH_BINS - 1; ++b) {
+		left.min = minOf(left.min, bins[b].min);
+		left.max = maxOf(left.max, bins[b].max);
+		left.count += bins[b].count;
+		leftCost[b] = left.count ? static_cast<float>(left.count) * halfArea(left.min, left.max) : INFINITY;
+	}
+	float bestCost = INFINITY;
+	int bestSplit = 0;
+	Bin right;
+	for (int b = BVH_BINS - 1; b > 0; --b) {
+		right.min = minOf(right.min, bins[b].min);
+		right.max = maxOf(right.max, bins[b].max);
+		right.count += bins[b].count;
+		const float cost = right.count ? leftCost[b - 1] + static_cast<float>(right.count) * halfArea(right.min, right.max) : INFINITY;
+		if (cost < bestCost) {
+			bestCost = cost;
+			bestSplit = b;
+		}
+	}
+	const float area = halfArea(node.min, node.max);
+	if (bestCost == INFINITY || (count <= BVH_MAX_LEAF_TRIANGLES && area + bestCost >= static_cast<float>(count) * area)) {
+		makeLeaf();
+		return;
+	}
+
+	BuildTriangle* items = build.items.data();
+	const BuildTriangle* middle = std::partition(items + first, items + first + count, [&](const BuildTriangle& item) {
+		return binOf(item.min, item.max, axis, binMin, toBin) < bestSplit;
+	});
+	const auto leftCount = static_cast<uint32_t>(middle - (items + first));
+	if (leftCount == 0 || leftCount == count) {
+		makeLeaf();
+		return;
+	}
+	const uint32_t children = build.nodesUsed.fetch_add(2, std::memory_order_relaxed);
+	node.leftOrFirst = children;
+	node.triangleCount = 0;
+	if (count <= BVH_TASK_TRIANGLES) {
+		this->subdivide(build, children, first, leftCount, level + 1);
+		this->subdivide(build, children + 1, first + leftCount, count - leftCount, level + 1);
+		return;
+	}
+	JobSystem& jobs = JobSystem::getInstance();
+	const JobHandle leftJob = jobs.submit([this, &build, children, first, leftCount, level] {
+		this->subdivide(build, children, first, leftCount, level + 1);
+	});
+	this->subdivide(build, children + 1, first + leftCount, count - leftCount, level + 1);
+	jobs.wait(leftJob);
+}
+
+// Slab test, returns the entry distance or INFINITY when the box is missed or farther than limit.
+static float enterBox(const BvhNode& node, const Vec3& origin, const Vec3& inverse, const float limit) {
+	const float x1 = (node.min.x - origin.x) * inverse.x, x2 = (node.max.x - origin.x) * inverse.x;
+	const float y1 = (node.min.y - origin.y) * inverse.y, y2 = (node.max.y - origin.y) * inverse.y;
+	const float z1 = (node.min.z - origin.z) * inverse.z, z2 = (node.max.z - origin.z) * inverse.z;
+	const float near = std::max({std::min(x1, x2), std::min(y1, y2), std::min(z1, z2), 0.0f});
+	const float far = std::min({std::max(x1, x2), std::max(y1, y2), std::max(z1, z2), limit});
+	return near <= far ? near : INFINITY;
+}
+
+bool Bvh::intersect(const Vec3& origin, const Vec3& direction, RayHit& hit) const {
+	const BvhView& view = this->view;
+	if (view.nodeCount == 0)
+		return false;
+	const Vec3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z); // Infinite on axis-parallel rays, which the slabs handle
+	uint32_t stack[BVH_MAX_DEPTH];
+	size_t top = 0;
+	uint32_t current = 0;
+	bool found = false;
+	while (true) {
+		const BvhNode& node = view.nodes[current];
+		if (node.triangleCount) {
+			for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.triangleCount; ++i) {
+				const BvhTriangle& triangle = view.triangles[i];
+				const Vec3 p = Vec3::cross(direction, triangle.edge2);
+				const float det = Vec3::dot(triangle.edge1, p);
+				if (det == 0.0f)
+					continue; // Parallel to the triangle, both sides are hit otherwise
+				const float inverseDet = 1.0f / det;
+				const Vec3 s = origin - triangle.v0;
+				const float u = Vec3::dot(s, p) * inverseDet;
+				if (u < 0.0f || u > 1.0f)
+					continue;
+				const Vec3 q = Vec3::cross(s, triangle.edge1);
+				const float v = Vec3::dot(direction, q) * inverseDet;
+				if (v < 0.0f || u + v > 1.0f)
+					continue;
+				const float distance = Vec3::dot(triangle.edge2, q) * inverseDet;
+				if (distance > 0.0f && distance < hit.distance) {
+					hit.distance = distance;
+					hit.triangle = view.triangleIds[i];
+					hit.u = u;
+					hit.v = v;
+					found = true;
+				}
+			}
+		}
+		else {
+			uint32_t near = node.leftOrFirst, far = near + 1;
+			float nearDistance = enterBox(view.nodes[near], origin, inverse, hit.distance);
+			float farDistance = enterBox(view.nodes[far], origin, inverse, hit.distance);
+			if (farDistance < nearDistance) {
+				std::swap(near, far);
+				std::swap(nearDistance, farDistance);
+			}
+			if (nearDistance != INFINITY) {
+				if (farDistance != INFINITY)
+					stack[top++] = far; // Revisited after the nearer subtree, when hit.distance may rule it out
+				current = near;
+				continue;
+			}
+		}
+		if (top == 0)
+			return found;
+		current = stack[--top];
+	}
+}
+
+void Bvh::clear() {
+	std::vector<BvhNode>().swap(this->nodes);
+	std::vector<BvhTriangle>().swap(this->triangles);
+	std::vector<uint32_t>().swap(this->triangleIds);
+	this->view = BvhView{};
+	this->buildMs = 0.0;
+}
+
+void Bvh::adopt(const BvhView& view) {
+	this->clear();
+	this->view = view;
+}
+
+void Bvh::printStats() const {
+	const BvhView& view = this->view;
+	if (view.nodeCount == 0)
+		return;
+	std::cout << "BVH: " << view.nodeCount - 1 << " nodes, " << view.leafCount << " leaves, depth " << view.depth
+		<< ", " << (view.nodeCount * sizeof(BvhNode) + view.triangleCount * (sizeof(BvhTriangle) + sizeof(uint32_t))) / 1024 << " KB, ";
+	if (this->nodes.empty())
+		std::cout << "shared" << std::endl;
+	else
+		std::cout << "built in " << this->buildMs << " ms" << std::endl;
+}
+
+bool Bvh::empty() const {
+	return this->view.nodeCount == 0;
+}
+
+size_t Bvh::getNodeCount() const {
+	return this->view.nodeCount == 0 ? 0 : this->view.nodeCount - 1; // Slot 1 is padding
+}
+
+const BvhNode& Bvh::getRoot() const {
+	return this->view.nodes[0];
+}
+
+double Bvh::getBuildMs() const {
+	return this->buildMs;
+}
+
+const BvhView& Bvh::getView() const {
+	return this->view;
+}
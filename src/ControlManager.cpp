@@ -11,6 +11,13 @@ ControlManager::ControlManager()
     this->controls[TOGGLE_KEY_LAYOUT] = XK_Tab;
     this->controls[RESET_POSITION] = XK_r;
     this->controls[TOGGLE_TEXTURE] = XK_space;
+    this->controls[CYCLE_PROJECTION] = XK_p;
+    this->controls[TOGGLE_CULLING] = XK_c;
+    this->controls[TOGGLE_LIGHTING] = XK_l;
+    this->controls[ADD_INSTANCES] = XK_KP_Add;
+    this->controls[REMOVE_INSTANCES] = XK_KP_Subtract;
+    this->controls[TAKE_SCREENSHOT] = XK_F12;
+    this->controls[TOGGLE_RECORDING] = XK_v;
     this->controls[DOWN] = XK_e;
     this->controls[UP] = XK_q;
     this->controls[RIGHT] = XK_d;
@@ -33,7 +40,14 @@ ControlManager::ControlManager()
     this->keyLayout[DOWN] = "DOWN";
     this->keyLayout[RESET_POSITION] = "RESET_POSITION";
     this->keyLayout[TOGGLE_TEXTURE] = "TOGGLE_TEXTURE";
+    this->keyLayout[CYCLE_PROJECTION] = "CYCLE_PROJECTION";
+    this->keyLayout[TOGGLE_CULLING] = "TOGGLE_CULLING";
+    this->keyLayout[TOGGLE_LIGHTING] = "TOGGLE_LIGHTING";
     this->keyLayout[TOGGLE_KEY_LAYOUT] = "TOGGLE_KEY_LAYOUT";
+    this->keyLayout[ADD_INSTANCES] = "ADD_INSTANCES";
+    this->keyLayout[REMOVE_INSTANCES] = "REMOVE_INSTANCES";
+    this->keyLayout[TAKE_SCREENSHOT] = "TAKE_SCREENSHOT";
+    this->keyLayout[TOGGLE_RECORDING] = "TOGGLE_RECORDING";
     this->keyLayout[EXIT] = "EXIT_PROGRAM";
 }
 
@@ -82,21 +96,49 @@ void ControlManager::checkActiveControls()
     for (const auto& [control, active] : this->activeControls) {
         if (active) {
             switch (control) {
-                case LEFT: ObjectData::getInstance().moveObject(LEFT); break;
-                case RIGHT: ObjectData::getInstance().moveObject(RIGHT); break;
-                case FORWARD: ObjectData::getInstance().moveObject(FORWARD); break;
-                case BACKWARD: ObjectData::getInstance().moveObject(BACKWARD); break;
-                case UP: ObjectData::getInstance().moveObject(UP); break;
-                case DOWN: ObjectData::getInstance().moveObject(DOWN); break;
-                case RESET_POSITION: ObjectData::getInstance().moveObject(RESET_POSITION); break;
+                case LEFT: Scene::getInstance().moveObject(LEFT); break;
+                case RIGHT: Scene::getInstance().moveObject(RIGHT); break;
+                case FORWARD: Scene::getInstance().moveObject(FORWARD); break;
+                case BACKWARD: Scene::getInstance().moveObject(BACKWARD); break;
+                case UP: Scene::getInstance().moveObject(UP); break;
+                case DOWN: Scene::getInstance().moveObject(DOWN); break;
+                case RESET_POSITION: Scene::getInstance().moveObject(RESET_POSITION); break;
                 case TOGGLE_TEXTURE:
                     if (this->justPressed(TOGGLE_TEXTURE)) {
-                        ObjectData::getInstance().toggleTexture();
+                        Scene::getInstance().toggleTexture();
+                    } break;
+                case CYCLE_PROJECTION:
+                    if (this->justPressed(CYCLE_PROJECTION)) {
+                        Scene::getInstance().cycleProjection();
+                    } break;
+                case TOGGLE_CULLING:
+                    if (this->justPressed(TOGGLE_CULLING)) {
+                        Scene::getInstance().toggleCulling();
+                    } break;
+                case TOGGLE_LIGHTING:
+                    if (this->justPressed(TOGGLE_LIGHTING)) {
+                        Scene::getInstance().toggleLighting();
                     } break;
                 case TOGGLE_KEY_LAYOUT:
                     if (this->justPressed(TOGGLE_KEY_LAYOUT)) {
                         this->switchKeyLayout();
                     } break;
+                case ADD_INSTANCES:
+                    if (this->justPressed(ADD_INSTANCES)) {
+                        Scene::getInstance().setInstanceCount(Scene::getInstance().getInstanceCount() * 2);
+                    } break;
+                case REMOVE_INSTANCES:
+                    if (this->justPressed(REMOVE_INSTANCES)) {
+                        Scene::getInstance().setInstanceCount(Scene::getInstance().getInstanceCount() / 2);
+                    } break;
+                case TAKE_SCREENSHOT:
+                    if (this->justPressed(TAKE_SCREENSHOT)) {
+                        WindowManager::getInstance().takeScreenshot();
+                    } break;
+                case TOGGLE_RECORDING:
+                    if (this->justPressed(TOGGLE_RECORDING)) {
+                        WindowManager::getInstance().toggleRecording();
+                    } break;
                 case EXIT: WindowManager::getInstance().exitProgram(); break;
             default: break;
             }
@@ -124,7 +166,7 @@ void ControlManager::switchKeyLayout() {
         this->controls[UP] = XK_q;
         this->controls[DOWN] = XK_e;
     }
-    clearTerminalLines(14);
+    clearTerminalLines(21);
     this->printInfo();
 }
 
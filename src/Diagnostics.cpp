@@ -0,0 +1,110 @@
+#include "Diagnostics.hpp"
+
+static const char* const categoryMessages[DIAGNOSTIC_CATEGORY_COUNT] = {
+	"Missing or malformed vertex coordinate, read as 0",
+	"Missing or malformed normal coordinate, read as 0",
+	"Invalid vertex index, face skipped",
+	"Vertex index too large to read, face skipped",
+	"Face with less than 3 vertices, skipped",
+	"Invalid normal index, normal generated instead"
+};
+
+static const char* const categoryKeys[DIAGNOSTIC_CATEGORY_COUNT] = {
+	"malformed_vertex",
+	"malformed_normal",
+	"invalid_index",
+	"index_overflow",
+	"short_face",
+	"invalid_normal_index"
+};
+
+void Diagnostics::add(const DiagnosticCategory category, const size_t line, const std::string_view detail) {
+	Category& entry = this->categories[category];
+	if (entry.count < DIAGNOSTIC_SAMPLES) {
+		Sample& sample = entry.samples[entry.count];
+		sample.line = line;
+		sample.length = std::min<size_t>(detail.size(), DIAGNOSTIC_DETAIL);
+		std::copy_n(detail.data(), sample.length, sample.detail);
+	}
+	entry.count++;
+}
+
+// Samples of the other collector come after ours in the file, so the earliest ones stay first.
+void Diagnostics::merge(const Diagnostics& other, const size_t lineOffset) {
+	if (this->strict && other.getTotal() > 0) {
+		const Sample* first = nullptr;
+		DiagnosticCategory firstCategory = MALFORMED_VERTEX;
+		for (int c = 0; c < DIAGNOSTIC_CATEGORY_COUNT; ++c) {
+			const Category& entry = other.categories[c];
+			if (entry.count > 0 && (first == nullptr || entry.samples[0].line < first->line)) {
+				first = &entry.samples[0];
+				firstCategory = static_cast<DiagnosticCategory>(c);
+			}
+		}
+		Sample sample = *first;
+		sample.line += lineOffset;
+		throw RuntimeException("ERROR: " + describe(firstCategory, sample) + " (--strict)");
+	}
+	for (int c = 0; c < DIAGNOSTIC_CATEGORY_COUNT; ++c) {
+		Category& entry = this->categories[c];
+		const Category& added = other.categories[c];
+		for (size_t s = 0; s < std::min<size_t>(added.count, DIAGNOSTIC_SAMPLES) && entry.count + s < DIAGNOSTIC_SAMPLES; ++s) {
+			entry.samples[entry.count + s] = added.samples[s];
+			entry.samples[entry.count + s].line += lineOffset;
+		}
+		entry.count += added.count;
+	}
+}
+
+void Diagnostics::clear() {
+	for (Category& entry : this->categories)
+		entry.count = 0;
+}
+
+void Diagnostics::setMode(const bool strict, const bool quiet) {
+	this->strict = strict;
+	this->quiet = quiet;
+}
+
+void Diagnostics::printSummary(const std::string& filename) const {
+	const size_t total = this->getTotal();
+	if (total == 0 || this->quiet)
+		return;
+	std::cout << YELLOW << "WARNING: " << total << " problems in " << filename << RESET << "\n";
+	for (int c = 0; c < DIAGNOSTIC_CATEGORY_COUNT; ++c) {
+		const Category& entry = this->categories[c];
+		if (entry.count == 0)
+			continue;
+		std::cout << "  " << YELLOW << categoryMessages[c] << ": " << BOLD << entry.count << RESET;
+		for (size_t s = 0; s < std::min<size_t>(entry.count, DIAGNOSTIC_SAMPLES); ++s) {
+			const Sample& sample = entry.samples[s];
+			std::cout << (s == 0 ? ", line " : ", ") << sample.line;
+			if (sample.length > 0)
+				std::cout << " \"" << sample.text() << "\"";
+		}
+		std::cout << (entry.count > DIAGNOSTIC_SAMPLES ? ", ..." : "") << "\n";
+	}
+	std::cout << std::flush; // One flush for the whole summary
+}
+
+size_t Diagnostics::getCount(const DiagnosticCategory category) const {
+	return this->categories[category].count;
+}
+
+size_t Diagnostics::getTotal() const {
+	size_t total = 0;
+	for (const Category& entry : this->categories)
+		total += entry.count;
+	return total;
+}
+
+const char* Diagnostics::keyOf(const DiagnosticCategory category) {
+	return categoryKeys[category];
+}
+
+std::string Diagnostics::describe(const DiagnosticCategory category, const Sample& sample) {
+	std::string text = std::string(categoryMessages[category]) + " at line " + std::to_string(sample.line);
+	if (sample.length > 0)
+		text += ": \"" + std::string(sample.text()) + "\"";
+	return text;
+}
@@ -0,0 +1,99 @@
+#include "DynamicBufferRing.hpp"
+
+static bool hasBufferStorage() {
+	GLint major = 0;
+	GLint minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	if (major > 4 || (major == 4 && minor >= 4))
+		return true;
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; ++i) {
+		const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+		if (name && std::strcmp(name, "GL_ARB_buffer_storage") == 0)
+			return true;
+	}
+	return false;
+}
+
+// Draws already issued keep the old buffer alive until they are done, nothing waits for them.
+void DynamicBufferRing::allocate(const size_t regionSize) {
+	if (this->buffer != 0)
+		glDeleteBuffers(1, &this->buffer);
+	for (GLsync& fence : this->fences) {
+		if (fence)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+	this->regionSize = regionSize;
+	const auto size = static_cast<GLsizeiptr>(regionSize * DYNAMIC_RING_FRAMES);
+	glGenBuffers(1, &this->buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+	if (this->persistent) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+		this->mapping = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+	}
+	else
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+}
+
+void DynamicBufferRing::beginFrame() {
+	if (this->buffer == 0) {
+		this->persistent = hasBufferStorage();
+		this->allocate(DYNAMIC_RING_INITIAL_SIZE);
+	}
+	this->region = (this->region + 1) % DYNAMIC_RING_FRAMES;
+	this->offset = 0;
+	GLsync& fence = this->fences[this->region];
+	if (!fence)
+		return;
+	if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+		this->stats.stalls++;
+		glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void DynamicBufferRing::endFrame() {
+	if (this->buffer != 0)
+		this->fences[this->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+GLintptr DynamicBufferRing::upload(const void* data, const size_t bytes) {
+	const size_t aligned = (bytes + DYNAMIC_RING_ALIGNMENT - 1) / DYNAMIC_RING_ALIGNMENT * DYNAMIC_RING_ALIGNMENT;
+	if (this->offset + aligned > this->regionSize) { // Uploads already made this frame stay in the old buffer
+		this->allocate(std::max(this->regionSize * 2, aligned));
+		this->offset = 0;
+		this->stats.grows++;
+	}
+	const size_t start = this->region * this->regionSize + this->offset;
+	glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+	if (this->mapping)
+		std::memcpy(this->mapping + start, data, bytes);
+	else if (bytes > 0) {
+		const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+		if (void* range = glMapBufferRange(GL_ARRAY_BUFFER, static_cast<GLintptr>(start), static_cast<GLsizeiptr>(bytes), access)) {
+			std::memcpy(range, data, bytes);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		}
+	}
+	this->offset += aligned;
+	this->stats.uploads++;
+	this->stats.bytes += bytes;
+	return static_cast<GLintptr>(start);
+}
+
+GLuint DynamicBufferRing::getBuffer() const {
+	return this->buffer;
+}
+
+bool DynamicBufferRing::isPersistent() const {
+	return this->persistent;
+}
+
+const DynamicRingStats& DynamicBufferRing::getStats() const {
+	return this->stats;
+}
@@ -0,0 +1,42 @@
+#include "FileWatcher.hpp"
+
+void FileWatcher::watch(const std::string& path) {
+	if (this->fd < 0) {
+		this->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (this->fd < 0)
+			throw RuntimeException("ERROR: Unable to start inotify");
+	}
+	const size_t slash = path.find_last_of('/');
+	const std::string directory = slash == std::string::npos ? "." : path.substr(0, std::max<size_t>(slash, 1));
+	const int descriptor = inotify_add_watch(this->fd, directory.c_str(), WATCH_EVENTS); // Same descriptor for a directory watched twice
+	if (descriptor < 0)
+		throw RuntimeException("ERROR: Unable to watch \"" + directory + "\"");
+	this->watches.push_back({descriptor, path.substr(slash == std::string::npos ? 0 : slash + 1), path});
+}
+
+std::vector<std::string> FileWatcher::poll() {
+	std::vector<std::string> changed;
+	if (this->fd < 0)
+		return changed;
+	alignas(inotify_event) char buffer[4096];
+	ssize_t length;
+	while ((length = read(this->fd, buffer, sizeof(buffer))) > 0) {
+		for (ssize_t offset = 0; offset < length;) {
+			const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+			if (event->len == 0)
+				continue;
+			for (const Watch& watch : this->watches) {
+				if (watch.descriptor == event->wd && watch.name == event->name
+					&& std::find(changed.begin(), changed.end(), watch.path) == changed.end())
+					changed.push_back(watch.path);
+			}
+		}
+	}
+	return changed;
+}
+
+FileWatcher::~FileWatcher() {
+	if (this->fd >= 0)
+		close(this->fd);
+}
@@ -0,0 +1,216 @@
+#include "FrameCapture.hpp"
+
+// First stem + number + suffix past last that does not exist yet, earlier captures are never
+// overwritten. last is updated so names handed out before their file is written are not reused.
+static std::string freePath(const std::string& stem, const std::string& suffix, int& last) {
+	std::filesystem::create_directories(CAPTURE_DIR);
+	while (true) {
+		char number[16];
+		std::snprintf(number, sizeof(number), "%03d", ++last);
+		const std::string path = std::string(CAPTURE_DIR) + "/" + stem + number + suffix;
+		if (!std::filesystem::exists(path))
+			return path;
+	}
+}
+
+void FrameCapture::screenshot() {
+	this->screenshotPending = true;
+}
+
+// Stopping waits for the take's reads still in flight, so the summary counts all of them and a
+// new take never shares its numbering with the last frames of this one.
+void FrameCapture::toggleRecording() {
+	this->recording = !this->recording;
+	if (!this->recording) {
+		for (size_t i = 0; i < CAPTURE_RING; ++i) // Oldest first, so the sequence stays in order
+			this->collect(this->slots[(this->head + i) % CAPTURE_RING], true);
+	}
+	clearTerminalLines(); // Status line under the controls
+	if (this->recording) {
+		int take = 0;
+		this->takePrefix = freePath("take", "_00000.ppm", take);
+		this->takePrefix.resize(this->takePrefix.size() - 9); // Frame numbers follow the take number
+		this->takeFrames = 0;
+		this->stats = CaptureStats{};
+		this->takeStart = std::chrono::steady_clock::now();
+		std::cout << RED << BOLD << "Recording" << RESET << " to " << this->takePrefix << "*.ppm" << std::flush;
+	}
+	else
+		this->printTake();
+}
+
+void FrameCapture::printTake() {
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->takeStart).count();
+	std::cout << "Recorded " << this->stats.frames << " frames in " << seconds << " s (" << this->stats.frames / seconds
+		<< " fps, target " << FPS_LIMIT << "), " << this->stats.renderThreadMs / std::max<size_t>(this->stats.frames, 1)
+		<< " ms per frame on the render thread, " << this->stats.dropped << " dropped, " << this->stats.stalls << " stalls";
+	const std::lock_guard<std::mutex> lock(this->mutex);
+	if (!this->writeError.empty())
+		std::cout << YELLOW << " WARNING: Unable to write " << this->writeError << RESET;
+	std::cout << std::flush;
+}
+
+// Slots are filled in order, so the oldest one is always the next to be reused.
+void FrameCapture::capture(const int width, const int height) {
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < CAPTURE_RING; ++i) // Oldest first, fences signal in the order they were queued
+		this->collect(this->slots[(this->head + i) % CAPTURE_RING], false);
+	if (!this->recording && !this->screenshotPending)
+		return;
+	const bool screenshot = this->screenshotPending;
+	this->screenshotPending = false;
+	Slot& slot = this->slots[this->head];
+	if (slot.fence) { // The GPU is CAPTURE_RING frames behind
+		this->stats.stalls++;
+		this->collect(slot, true);
+	}
+	this->issue(slot, width, height, screenshot);
+	this->head = (this->head + 1) % CAPTURE_RING;
+	if (this->recording) {
+		this->stats.frames++;
+		this->stats.renderThreadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+// RGBA is the layout drivers read back without converting, the writer drops the alpha.
+void FrameCapture::issue(Slot& slot, const int width, const int height, const bool screenshot) {
+	const size_t size = static_cast<size_t>(width) * height * 4;
+	if (slot.buffer == 0)
+		glGenBuffers(1, &slot.buffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	if (slot.size != size) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+		slot.size = size;
+	}
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadBuffer(GL_BACK);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr); // Queued, the data lands in the buffer
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.width = width;
+	slot.height = height;
+	slot.screenshot = screenshot;
+}
+
+// Copies a finished read out of its buffer and hands it to the writer. Without wait, a read the
+// GPU has not completed yet stays in its slot for a later frame. Files are named here, once the
+// frame is sure to be written: a screenshot waits for room in the writer queue instead of being
+// dropped, a recording frame is dropped and takes no number.
+void FrameCapture::collect(Slot& slot, const bool wait) {
+	if (!slot.fence)
+		return;
+	const GLenum status = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GL_TIMEOUT_IGNORED : 0);
+	if (status == GL_TIMEOUT_EXPIRED)
+		return;
+	glDeleteSync(slot.fence);
+	slot.fence = nullptr;
+	std::unique_lock<std::mutex> lock(this->mutex);
+	if (slot.screenshot)
+		this->room.wait(lock, [this] { return this->queue.size() < CAPTURE_QUEUE; });
+	else if (this->queue.size() >= CAPTURE_QUEUE) {
+		this->stats.dropped++;
+		return;
+	}
+	std::vector<unsigned char> pixels;
+	if (!this->spare.empty()) {
+		pixels = std::move(this->spare.back());
+		this->spare.pop_back();
+	}
+	lock.unlock();
+	pixels.resize(slot.size);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	if (const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(slot.size), GL_MAP_READ_BIT)) {
+		std::memcpy(pixels.data(), mapped, slot.size);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	std::string path;
+	if (slot.screenshot) {
+		path = freePath("screenshot", ".ppm", this->screenshotNumber);
+		clearTerminalLines();
+		std::cout << "Screenshot saved to " << path << std::flush;
+	}
+	else {
+		char number[16];
+		std::snprintf(number, sizeof(number), "%05zu", this->takeFrames++);
+		path = this->takePrefix + number + ".ppm";
+	}
+	if (!this->writer.joinable())
+		this->startWriter();
+	lock.lock();
+	this->queue.push_back({std::move(pixels), slot.width, slot.height, std::move(path)});
+	lock.unlock();
+	this->wake.notify_one();
+}
+
+void FrameCapture::startWriter() {
+	this->stopping = false;
+	this->writer = std::thread([this] { this->writeFrames(); });
+}
+
+// Writer side: flips the rows to top first and packs RGB, then gives the storage back.
+void FrameCapture::writeFrames() {
+	std::vector<unsigned char> rgb;
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true) {
+		this->wake.wait(lock, [this] { return this->stopping || !this->queue.empty(); });
+		if (this->queue.empty())
+			return; // Stopping with nothing left to write
+		Frame frame = std::move(this->queue.front());
+		this->queue.pop_front();
+		lock.unlock();
+		this->room.notify_one();
+		const size_t row = static_cast<size_t>(frame.width) * 3;
+		rgb.resize(row * frame.height);
+		for (int y = 0; y < frame.height; ++y) {
+			const unsigned char* source = frame.pixels.data() + static_cast<size_t>(frame.height - 1 - y) * frame.width * 4;
+			unsigned char* target = rgb.data() + y * row;
+			for (int x = 0; x < frame.width; ++x) {
+				target[x * 3] = source[x * 4];
+				target[x * 3 + 1] = source[x * 4 + 1];
+				target[x * 3 + 2] = source[x * 4 + 2];
+			}
+		}
+		std::ofstream file(frame.path, std::ios::binary);
+		file << "P6\n" << frame.width << " " << frame.height << "\n255\n";
+		file.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+		lock.lock();
+		if (!file && this->writeError.empty())
+			this->writeError = frame.path;
+		this->spare.push_back(std::move(frame.pixels));
+	}
+}
+
+void FrameCapture::finish() {
+	if (this->recording)
+		this->toggleRecording();
+	for (size_t i = 0; i < CAPTURE_RING; ++i) // Oldest first, so a sequence stays in order
+		this->collect(this->slots[(this->head + i) % CAPTURE_RING], true);
+	for (Slot& slot : this->slots) {
+		glDeleteBuffers(1, &slot.buffer);
+		slot = Slot{};
+	}
+	if (this->writer.joinable()) {
+		{
+			const std::lock_guard<std::mutex> lock(this->mutex);
+			this->stopping = true;
+		}
+		this->wake.notify_one();
+		this->writer.join();
+	}
+}
+
+bool FrameCapture::isRecording() const {
+	return this->recording;
+}
+
+FrameCapture::~FrameCapture() {
+	if (this->writer.joinable()) { // finish() was not called, pending reads are lost with the context
+		{
+			const std::lock_guard<std::mutex> lock(this->mutex);
+			this->stopping = true;
+		}
+		this->wake.notify_one();
+		this->writer.join();
+	}
+}
@@ -0,0 +1,227 @@
+#include "JobSystem.hpp"
+
+thread_local size_t JobSystem::queueIndex = 0;
+
+bool Job::isDone() const {
+	return this->done.load(std::memory_order_acquire);
+}
+
+JobSystem& JobSystem::getInstance() {
+	static JobSystem instance;
+	return instance;
+}
+
+JobSystem::JobSystem() {
+	this->start(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+JobSystem::~JobSystem() {
+	this->stop();
+}
+
+void JobSystem::start(const size_t threads) {
+	this->stopping = false;
+	for (size_t i = 0; i < threads; ++i)
+		this->queues.push_back(std::make_unique<Queue>());
+	for (size_t i = 1; i < threads; ++i) // The caller is the first thread
+		this->workers.emplace_back(&JobSystem::workerLoop, this, i);
+	if (this->workers.empty())
+		this->backgroundThread = std::thread(&JobSystem::backgroundLoop, this);
+}
+
+void JobSystem::stop() {
+	{
+		const std::lock_guard<std::mutex> lock(this->sleepMutex);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	for (std::thread& worker : this->workers)
+		worker.join();
+	if (this->backgroundThread.joinable())
+		this->backgroundThread.join();
+	this->workers.clear();
+	this->queues.clear();
+	this->background.jobs.clear();
+	this->queued = 0;
+	this->backgroundQueued = 0;
+}
+
+void JobSystem::setThreadCount(const size_t threads) {
+	this->stop();
+	this->start(std::max<size_t>(threads, 1));
+}
+
+size_t JobSystem::getThreadCount() const {
+	return this->queues.size();
+}
+
+size_t JobSystem::getSteals() const {
+	return this->steals.load(std::memory_order_relaxed);
+}
+
+size_t JobSystem::chunkCount(const size_t count, const size_t minChunk) const {
+	const size_t threads = this->getThreadCount();
+	const size_t limit = threads == 1 ? 1 : threads * JOB_CHUNKS_PER_THREAD;
+	return std::clamp<size_t>(count / std::max<size_t>(minChunk, 1), 1, limit);
+}
+
+JobHandle JobSystem::submit(std::function<void()> function, const std::initializer_list<JobHandle> dependencies) {
+	JobHandle job = std::make_shared<Job>();
+	job->function = std::move(function);
+	job->pendingDependencies.fetch_add(dependencies.size(), std::memory_order_relaxed);
+	for (const JobHandle& dependency : dependencies) {
+		const std::lock_guard<std::mutex> lock(dependency->dependentsMutex);
+		if (dependency->done.load(std::memory_order_acquire))
+			job->pendingDependencies.fetch_sub(1, std::memory_order_relaxed);
+		else
+			dependency->dependents.push_back(job);
+	}
+	if (job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		this->push(job);
+	return job;
+}
+
+JobHandle JobSystem::submitBackground(std::function<void()> function) {
+	JobHandle job = std::make_shared<Job>();
+	job->function = std::move(function);
+	job->pendingDependencies = 0;
+	{
+		const std::lock_guard<std::mutex> lock(this->background.mutex);
+		this->background.jobs.push_back(job);
+	}
+	this->backgroundQueued.fetch_add(1, std::memory_order_release);
+	{
+		const std::lock_guard<std::mutex> lock(this->sleepMutex);
+	}
+	this->wake.notify_all(); // The thread woken by notify_one might not serve this queue
+	return job;
+}
+
+// Takes a background job back out of the queue before any thread started it. It then counts as
+// done without having run, dependents included. False once a thread has picked it up.
+bool JobSystem::cancel(const JobHandle& job) {
+	{
+		const std::lock_guard<std::mutex> lock(this->background.mutex);
+		const auto found = std::find(this->background.jobs.begin(), this->background.jobs.end(), job);
+		if (found == this->background.jobs.end())
+			return false;
+		this->background.jobs.erase(found);
+		this->backgroundQueued.fetch_sub(1, std::memory_order_relaxed);
+	}
+	this->finish(job);
+	return true;
+}
+
+void JobSystem::push(JobHandle job) {
+	Queue& queue = *this->queues[queueIndex];
+	{
+		const std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+	}
+	this->queued.fetch_add(1, std::memory_order_release);
+	{
+		const std::lock_guard<std::mutex> lock(this->sleepMutex); // Pairs with the wait predicate, no lost wake-ups
+	}
+	this->wake.notify_one();
+}
+
+// Newest job of the own deque first (still hot in cache), otherwise the oldest job of another.
+JobHandle JobSystem::pop() {
+	const size_t count = this->queues.size();
+	for (size_t i = 0; i < count; ++i) {
+		Queue& queue = *this->queues[(queueIndex + i) % count];
+		const std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty())
+			continue;
+		JobHandle job;
+		if (i == 0) {
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+		}
+		else {
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			this->steals.fetch_add(1, std::memory_order_relaxed);
+		}
+		this->queued.fetch_sub(1, std::memory_order_relaxed);
+		return job;
+	}
+	return nullptr;
+}
+
+JobHandle JobSystem::popBackground() {
+	const std::lock_guard<std::mutex> lock(this->background.mutex);
+	if (this->background.jobs.empty())
+		return nullptr;
+	JobHandle job = std::move(this->background.jobs.front());
+	this->background.jobs.pop_front();
+	this->backgroundQueued.fetch_sub(1, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::run(const JobHandle& job) {
+	job->function();
+	this->finish(job);
+}
+
+void JobSystem::finish(const JobHandle& job) {
+	job->function = nullptr; // Drop the captures now, handles may outlive the job
+	std::vector<JobHandle> dependents;
+	{
+		const std::lock_guard<std::mutex> lock(job->dependentsMutex);
+		job->done.store(true, std::memory_order_release);
+		dependents.swap(job->dependents);
+	}
+	for (JobHandle& dependent : dependents) {
+		if (dependent->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			this->push(std::move(dependent));
+	}
+}
+
+bool JobSystem::helpOnce() {
+	const JobHandle job = this->pop();
+	if (!job)
+		return false;
+	this->run(job);
+	return true;
+}
+
+void JobSystem::wait(const JobHandle& job) {
+	while (!job->isDone()) {
+		if (!this->helpOnce())
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::workerLoop(const size_t index) {
+	queueIndex = index;
+	while (true) {
+		if (this->helpOnce())
+			continue;
+		if (const JobHandle job = this->popBackground()) { // Ordinary jobs first, someone may be waiting on them
+			this->run(job);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(this->sleepMutex);
+		this->wake.wait(lock, [this] {
+			return this->stopping || this->queued.load(std::memory_order_acquire) > 0 || this->backgroundQueued.load(std::memory_order_acquire) > 0;
+		});
+		if (this->stopping)
+			return;
+	}
+}
+
+// Jobs it splits into go to the shared deque, where waiting threads may help with them.
+void JobSystem::backgroundLoop() {
+	queueIndex = 0;
+	while (true) {
+		if (const JobHandle job = this->popBackground()) {
+			this->run(job);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(this->sleepMutex);
+		this->wake.wait(lock, [this] { return this->stopping || this->backgroundQueued.load(std::memory_order_acquire) > 0; });
+		if (this->stopping)
+			return;
+	}
+}
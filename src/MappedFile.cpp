@@ -0,0 +1,70 @@
+#include "MappedFile.hpp"
+
+void MappedFile::openReadOnly(const std::string& path) {
+	this->close();
+	this->fd = ::open(path.c_str(), O_RDONLY);
+	if (this->fd < 0)
+		throw RuntimeException("ERROR: Unable to open \"" + path + "\"");
+	struct stat info{};
+	fstat(this->fd, &info);
+	this->length = static_cast<size_t>(info.st_size);
+	this->map(PROT_READ, path);
+}
+
+void MappedFile::create(const std::string& path, const size_t size) {
+	this->close();
+	this->fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (this->fd < 0 || ftruncate(this->fd, static_cast<off_t>(size)) != 0)
+		throw RuntimeException("ERROR: Unable to create \"" + path + "\"");
+	this->length = size;
+	this->map(PROT_READ | PROT_WRITE, path);
+}
+
+void MappedFile::map(const int protection, const std::string& path) {
+	if (this->length == 0)
+		return; // mmap rejects empty ranges, an empty file simply has no data
+	void* address = mmap(nullptr, this->length, protection, MAP_SHARED, this->fd, 0);
+	if (address == MAP_FAILED) {
+		this->close();
+		throw RuntimeException("ERROR: Unable to map \"" + path + "\"");
+	}
+	this->mapping = static_cast<unsigned char*>(address);
+}
+
+void MappedFile::close() {
+	if (this->mapping)
+		munmap(this->mapping, this->length);
+	if (this->fd >= 0)
+		::close(this->fd);
+	this->mapping = nullptr;
+	this->length = 0;
+	this->fd = -1;
+}
+
+static void adviseRange(unsigned char* mapping, const size_t offset, const size_t length, const int advice) {
+	const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const size_t begin = offset / page * page; // madvise wants a page-aligned start
+	madvise(mapping + begin, length + offset - begin, advice);
+}
+
+void MappedFile::release(const size_t offset, const size_t length) const {
+	if (this->mapping)
+		adviseRange(this->mapping, offset, length, MADV_DONTNEED);
+}
+
+void MappedFile::prefetch(const size_t offset, const size_t length) const {
+	if (this->mapping)
+		adviseRange(this->mapping, offset, length, MADV_WILLNEED);
+}
+
+unsigned char* MappedFile::data() const {
+	return this->mapping;
+}
+
+size_t MappedFile::size() const {
+	return this->length;
+}
+
+MappedFile::~MappedFile() {
+	this->close();
+}
@@ -0,0 +1,226 @@
+#include "MeshChunker.hpp"
+
+#define CHUNK_READ_BUFFER (1 << 19)
+#define CHUNK_GRID_LIMIT 64 // Cells per axis of the bucketing grid
+
+static std::string chunkPath(const std::string& objPath) {
+	if (objPath.size() < 5 || objPath.substr(objPath.size() - 4) != ".obj")
+		throw WrongExtensionException();
+	return objPath.substr(0, objPath.size() - 4) + ".smc";
+}
+
+MeshChunker::MeshChunker(std::string outPath) : outPath(std::move(outPath)) {}
+
+void MeshChunker::build(const std::string& objPath) {
+	MeshChunker chunker(chunkPath(objPath));
+	std::cout << BOLD << "Chunking " << objPath << "..." << RESET << std::endl;
+	chunker.spill(objPath);
+	if (chunker.vertexCount == 0 || chunker.triangleCount == 0)
+		throw RuntimeException("ERROR: No vertices or faces found in the OBJ file.");
+	chunker.computeQuantization();
+	chunker.writeClusters();
+	std::cout << GREEN << BOLD << chunker.outPath << " written: " << chunker.header.triangleCount << " triangles in "
+		<< chunker.header.clusterCount << " clusters" << RESET << std::endl;
+	if (chunker.skippedFaces > 0)
+		std::cout << YELLOW << "WARNING: " << chunker.skippedFaces << " malformed faces skipped" << RESET << std::endl;
+}
+
+// First pass: stream the OBJ once, append positions and fan-triangulated faces to temporary
+// files and track the bounds. Indices are resolved to 64-bit, relative ones included.
+void MeshChunker::spill(const std::string& objPath) {
+	std::ifstream file(objPath, std::ios::binary);
+	if (!file.is_open())
+		throw UnableToOpenOBJException();
+	const std::string positionsPath = this->outPath + ".positions.tmp";
+	const std::string trianglesPath = this->outPath + ".triangles.tmp";
+	{
+		std::ofstream positionOut(positionsPath, std::ios::binary);
+		std::ofstream triangleOut(trianglesPath, std::ios::binary);
+		if (!positionOut.is_open() || !triangleOut.is_open())
+			throw RuntimeException("ERROR: Unable to create temporary files next to " + this->outPath);
+		std::pmr::vector<char> buffer(CHUNK_READ_BUFFER);
+		std::vector<uint64_t> face;
+		forEachLine(file, buffer, [&](std::string_view line) {
+			const std::string_view type = nextToken(line);
+			if (type == "v") {
+				const float vertex[3] = {parseFloat(line), parseFloat(line), parseFloat(line)};
+				for (int axis = 0; axis < 3; ++axis) {
+					this->min[axis] = std::min(this->min[axis], vertex[axis]);
+					this->max[axis] = std::max(this->max[axis], vertex[axis]);
+					this->sum[axis] += vertex[axis];
+				}
+				positionOut.write(reinterpret_cast<const char*>(vertex), sizeof(vertex));
+				this->vertexCount++;
+			}
+			else if (type == "f") {
+				face.clear();
+				for (std::string_view part = nextToken(line); !part.empty(); part = nextToken(line)) {
+					int64_t index = 0;
+					const std::string_view digits = part.substr(0, part.find('/'));
+					if (std::from_chars(digits.data(), digits.data() + digits.size(), index).ec != std::errc() || index == 0) {
+						face.clear();
+						break;
+					}
+					face.push_back(index > 0 ? static_cast<uint64_t>(index - 1) : this->vertexCount + index); // Negative indices are relative
+				}
+				if (face.size() < 3) {
+					this->skippedFaces++;
+					return;
+				}
+				for (size_t i = 1; i < face.size() - 1; ++i) {
+					const uint64_t triangle[3] = {face[0], face[i], face[i + 1]};
+					triangleOut.write(reinterpret_cast<const char*>(triangle), sizeof(triangle));
+					this->triangleCount++;
+				}
+			}
+		});
+	}
+	this->positions.openReadOnly(positionsPath);
+	this->triangles.openReadOnly(trianglesPath);
+}
+
+Vec3 MeshChunker::vertexAt(const uint64_t index) const {
+	float p[3];
+	std::memcpy(p, this->positions.data() + index * sizeof(p), sizeof(p));
+	return {p[0], p[1], p[2]};
+}
+
+// Second pass over the mapped positions: radius around the centroid and planar UV range.
+void MeshChunker::computeQuantization() {
+	ChunkFileHeader& h = this->header;
+	std::memcpy(h.magic, CHUNK_MAGIC, sizeof(h.magic));
+	h.vertexCount = this->vertexCount;
+	const Vec3 center(static_cast<float>(this->sum[0] / static_cast<double>(this->vertexCount)),
+		static_cast<float>(this->sum[1] / static_cast<double>(this->vertexCount)),
+		static_cast<float>(this->sum[2] / static_cast<double>(this->vertexCount)));
+	const float centerAxis[3] = {center.x, center.y, center.z};
+	float localMin[3], localMax[3];
+	for (int axis = 0; axis < 3; ++axis) {
+		h.center[axis] = centerAxis[axis];
+		localMin[axis] = this->min[axis] - centerAxis[axis];
+		localMax[axis] = this->max[axis] - centerAxis[axis];
+		h.positionOffset[axis] = (localMin[axis] + localMax[axis]) / 2.0f;
+		h.positionScale[axis] = std::max((localMax[axis] - localMin[axis]) / 2.0f, 1e-30f);
+	}
+	this->projection = makeProjectionSetup(localMin, localMax);
+
+	float radiusSq = 0.0f;
+	float uvMin[2] = {+INFINITY, +INFINITY}, uvMax[2] = {-INFINITY, -INFINITY};
+	for (uint64_t i = 0; i < this->vertexCount; ++i) {
+		const Vec3 p = this->vertexAt(i) - center;
+		radiusSq = std::max(radiusSq, Vec3::dot(p, p));
+		const Vec2 uv = projectPlanar(this->projection, p.y, p.z);
+		uvMin[0] = std::min(uvMin[0], uv.u);
+		uvMin[1] = std::min(uvMin[1], uv.v);
+		uvMax[0] = std::max(uvMax[0], uv.u);
+		uvMax[1] = std::max(uvMax[1], uv.v);
+	}
+	h.radius = std::sqrt(radiusSq);
+	for (int axis = 0; axis < 2; ++axis) {
+		h.texCoordTransform[axis] = std::max((uvMax[axis] - uvMin[axis]) / 2.0f, 1e-30f);
+		h.texCoordTransform[axis + 2] = (uvMin[axis] + uvMax[axis]) / 2.0f;
+	}
+}
+
+// Counting sort of the triangles into grid cells, then every cell is cut into clusters and
+// written straight into the mapped output. Written blocks are released as soon as they are done.
+void MeshChunker::writeClusters() {
+	ChunkFileHeader& h = this->header;
+	const uint64_t* tri = reinterpret_cast<const uint64_t*>(this->triangles.data());
+	const Vec3 center(h.center[0], h.center[1], h.center[2]);
+	const Vec3 localMin = Vec3(this->min[0], this->min[1], this->min[2]) - center;
+	const Vec3 extent = Vec3(this->max[0], this->max[1], this->max[2]) - center - localMin;
+	const auto grid = static_cast<size_t>(std::clamp<double>(
+		std::round(std::cbrt(static_cast<double>(this->triangleCount) / CHUNK_TRIANGLES)), 1.0, CHUNK_GRID_LIMIT));
+	const size_t invalidCell = grid * grid * grid;
+	auto cellOf = [&](const uint64_t t) {
+		for (int j = 0; j < 3; ++j) {
+			if (tri[t * 3 + j] >= this->vertexCount)
+				return invalidCell;
+		}
+		const Vec3 centroid = (this->vertexAt(tri[t * 3]) + this->vertexAt(tri[t * 3 + 1]) + this->vertexAt(tri[t * 3 + 2])) * (1.0f / 3.0f) - center;
+		const float relative[3] = {(centroid.x - localMin.x) / std::max(extent.x, 1e-30f),
+			(centroid.y - localMin.y) / std::max(extent.y, 1e-30f), (centroid.z - localMin.z) / std::max(extent.z, 1e-30f)};
+		size_t cell = 0;
+		for (const float r : relative)
+			cell = cell * grid + std::min(static_cast<size_t>(std::max(r, 0.0f) * static_cast<float>(grid)), grid - 1);
+		return cell;
+	};
+
+	std::vector<uint64_t> cellStart(invalidCell + 1, 0);
+	for (uint64_t t = 0; t < this->triangleCount; ++t) {
+		const size_t cell = cellOf(t);
+		if (cell == invalidCell)
+			this->skippedFaces++; // Index past the last vertex
+		else
+			cellStart[cell + 1]++;
+	}
+	for (size_t cell = 1; cell <= invalidCell; ++cell)
+		cellStart[cell] += cellStart[cell - 1];
+	const uint64_t validTriangles = cellStart[invalidCell];
+	MappedFile order;
+	order.create(this->outPath + ".order.tmp", std::max<uint64_t>(validTriangles, 1) * sizeof(uint64_t));
+	auto* sorted = reinterpret_cast<uint64_t*>(order.data());
+	std::vector<uint64_t> next(cellStart.begin(), cellStart.end() - 1);
+	for (uint64_t t = 0; t < this->triangleCount; ++t) {
+		const size_t cell = cellOf(t);
+		if (cell != invalidCell)
+			sorted[next[cell]++] = t;
+	}
+
+	std::vector<ChunkCluster> clusters;
+	for (size_t cell = 0; cell < invalidCell; ++cell) {
+		for (uint64_t first = cellStart[cell]; first < cellStart[cell + 1]; first += CHUNK_TRIANGLES) {
+			ChunkCluster cluster{};
+			cluster.triangleCount = static_cast<uint32_t>(std::min<uint64_t>(CHUNK_TRIANGLES, cellStart[cell + 1] - first));
+			cluster.offset = first; // Start in the sorted order for now, turned into a byte offset below
+			clusters.push_back(cluster);
+		}
+	}
+	h.triangleCount = validTriangles;
+	h.clusterCount = clusters.size();
+	const size_t tableEnd = sizeof(ChunkFileHeader) + clusters.size() * sizeof(ChunkCluster);
+	size_t fileSize = (tableEnd + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT;
+	for (const ChunkCluster& cluster : clusters)
+		fileSize += chunkBlockSize(cluster.triangleCount);
+
+	MappedFile out;
+	out.create(this->outPath, fileSize);
+	size_t offset = (tableEnd + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT;
+	std::vector<Vec3> corners(CHUNK_TRIANGLES * 3);
+	const Vec3 toNormalized(1.0f / h.positionScale[0], 1.0f / h.positionScale[1], 1.0f / h.positionScale[2]);
+	const Vec3 positionOffset(h.positionOffset[0], h.positionOffset[1], h.positionOffset[2]);
+	for (ChunkCluster& cluster : clusters) {
+		const uint64_t first = cluster.offset;
+		const size_t cornerCount = static_cast<size_t>(cluster.triangleCount) * 3;
+		auto* vertices = reinterpret_cast<PackedVertex*>(out.data() + offset);
+		auto* texCoords = reinterpret_cast<PackedTexCoord*>(out.data() + offset + cornerCount * sizeof(PackedVertex));
+		for (size_t c = 0; c < cornerCount; ++c) {
+			const uint64_t t = sorted[first + c / 3];
+			const Vec3 p = this->vertexAt(tri[t * 3 + c % 3]) - center;
+			corners[c] = p;
+			const Vec3 normalized = p - positionOffset;
+			vertices[c].position[0] = quantizeSnorm(normalized.x * toNormalized.x);
+			vertices[c].position[1] = quantizeSnorm(normalized.y * toNormalized.y);
+			vertices[c].position[2] = quantizeSnorm(normalized.z * toNormalized.z);
+			vertices[c].shade = shadeOf(t);
+			vertices[c].padding = 0;
+			const Vec2 uv = projectPlanar(this->projection, p.y, p.z);
+			texCoords[c].u = quantizeSnorm((uv.u - h.texCoordTransform[2]) / h.texCoordTransform[0]);
+			texCoords[c].v = quantizeSnorm((uv.v - h.texCoordTransform[3]) / h.texCoordTransform[1]);
+		}
+		cluster.bounds = computeClusterBounds(corners.data(), cluster.triangleCount);
+		cluster.offset = offset;
+		out.release(offset, chunkBlockSize(cluster.triangleCount)); // Dirty pages stay in the page cache for writeback
+		offset += chunkBlockSize(cluster.triangleCount);
+	}
+	std::memcpy(out.data(), &h, sizeof(h));
+	std::memcpy(out.data() + sizeof(h), clusters.data(), clusters.size() * sizeof(ChunkCluster));
+
+	order.close();
+	this->positions.close();
+	this->triangles.close();
+	std::remove((this->outPath + ".order.tmp").c_str());
+	std::remove((this->outPath + ".positions.tmp").c_str());
+	std::remove((this->outPath + ".triangles.tmp").c_str());
+}
@@ -0,0 +1,218 @@
+#include "MeshStore.hpp"
+
+// Any edit gives the file a new mtime and therefore a new segment, a stale one is never mapped.
+// The user is part of the name so nobody else can take it first.
+std::string MeshStore::nameOf(const std::string& path) {
+	struct stat info{};
+	if (stat(path.c_str(), &info) != 0)
+		return "";
+	char name[160];
+	std::snprintf(name, sizeof(name), "/" MESH_STORE_PREFIX "%llx-%llx-%llx-%llx-%llx", static_cast<unsigned long long>(geteuid()),
+		static_cast<unsigned long long>(info.st_dev), static_cast<unsigned long long>(info.st_ino),
+		static_cast<unsigned long long>(info.st_size),
+		static_cast<unsigned long long>(info.st_mtim.tv_sec) * 1000000000ull + static_cast<unsigned long long>(info.st_mtim.tv_nsec));
+	return name;
+}
+
+static bool isAlive(const int32_t pid) {
+	return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+// Mapped over its whole capacity, pages past a trimmed end are never touched. Only segments of
+// this user whose layout fits in the file are trusted.
+bool MeshStore::open(const std::string& name) {
+	this->close();
+	if (name.empty())
+		return false;
+	this->name = name;
+	bool announced = false;
+	while (true) {
+		this->fd = shm_open(this->name.c_str(), O_RDONLY, 0);
+		if (this->fd < 0)
+			return false;
+		struct stat info{};
+		if (fstat(this->fd, &info) != 0 || info.st_uid != geteuid()) {
+			this->close();
+			return false;
+		}
+		this->length = static_cast<size_t>(info.st_size);
+		if (this->length >= sizeof(MeshStoreHeader) && this->map(PROT_READ)) {
+			const MeshStoreHeader* header = this->header();
+			if (header->version != MESH_STORE_VERSION) {
+				this->close();
+				return false; // Left by another build of scop
+			}
+			if (header->state.load(std::memory_order_acquire) != MESH_STORE_WRITING) {
+				const size_t fileSize = this->length;
+				const size_t capacity = header->capacity;
+				munmap(this->mapping, this->length);
+				this->mapping = nullptr;
+				this->length = capacity;
+				if (capacity >= fileSize && this->map(PROT_READ) && this->fitsIn(fileSize) && flock(this->fd, LOCK_SH) == 0) {
+					this->locked = true;
+					return true;
+				}
+				this->close();
+				return false; // Truncated or not written by scop
+			}
+			if (!isAlive(header->writer)) {
+				shm_unlink(this->name.c_str()); // Its writer died half way
+				this->close();
+				return false;
+			}
+			if (!announced)
+				std::cout << "Waiting for process " << header->writer << " to publish " << this->name << "..." << std::endl;
+			announced = true;
+		}
+		this->close();
+		std::this_thread::sleep_for(std::chrono::milliseconds(MESH_STORE_POLL_MS));
+	}
+}
+
+bool MeshStore::create(const std::string& name, const std::vector<size_t>& sizes) {
+	this->close();
+	if (sizes.empty() || sizes.size() > MESH_STORE_ARRAYS)
+		throw RuntimeException("ERROR: Invalid shared mesh layout");
+	if (name.empty())
+		return false;
+	this->name = name;
+	this->fd = shm_open(this->name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (this->fd < 0)
+		return false;
+	this->owner = true;
+	MeshStoreHeader layout{};
+	size_t offset = (sizeof(MeshStoreHeader) + MESH_STORE_ALIGNMENT - 1) / MESH_STORE_ALIGNMENT * MESH_STORE_ALIGNMENT;
+	for (size_t i = 0; i < sizes.size(); ++i) {
+		layout.offsets[i] = offset;
+		layout.sizes[i] = sizes[i];
+		offset += (sizes[i] + MESH_STORE_ALIGNMENT - 1) / MESH_STORE_ALIGNMENT * MESH_STORE_ALIGNMENT;
+	}
+	this->length = offset;
+	this->locked = flock(this->fd, LOCK_SH) == 0; // Nobody else can have it yet
+	const size_t reserved = layout.offsets[sizes.size() - 1]; // The last array only gets pages once its size is known
+	if (ftruncate(this->fd, static_cast<off_t>(this->length)) != 0 || posix_fallocate(this->fd, 0, static_cast<off_t>(reserved)) != 0
+		|| !this->map(PROT_READ | PROT_WRITE)) {
+		this->close(); // Touching pages tmpfs cannot back would raise SIGBUS
+		return false;
+	}
+	MeshStoreHeader* header = this->header();
+	header->state.store(MESH_STORE_WRITING, std::memory_order_relaxed);
+	header->version = MESH_STORE_VERSION;
+	header->writer = getpid();
+	header->arrayCount = static_cast<uint32_t>(sizes.size());
+	header->capacity = this->length;
+	std::copy(std::begin(layout.offsets), std::end(layout.offsets), header->offsets);
+	std::copy(std::begin(layout.sizes), std::end(layout.sizes), header->sizes);
+	this->removeOlderVersions();
+	return true;
+}
+
+void MeshStore::publish() {
+	this->header()->state.store(MESH_STORE_READY, std::memory_order_release);
+}
+
+void MeshStore::resizeLast(const size_t bytes) {
+	MeshStoreHeader* header = this->header();
+	const size_t last = header->arrayCount - 1;
+	header->sizes[last] = bytes;
+	if (posix_fallocate(this->fd, static_cast<off_t>(header->offsets[last]), static_cast<off_t>(std::max<size_t>(bytes, 1))) != 0)
+		throw RuntimeException("ERROR: Out of shared memory for " + this->name);
+}
+
+void MeshStore::complete() {
+	MeshStoreHeader* header = this->header();
+	const size_t last = header->arrayCount - 1;
+	if (ftruncate(this->fd, static_cast<off_t>(header->offsets[last] + header->sizes[last])) != 0)
+		throw RuntimeException("ERROR: Unable to trim " + this->name);
+	header->state.store(MESH_STORE_COMPLETE, std::memory_order_release);
+}
+
+// Every array but the last lies within the file, the last within the capacity since it may not be
+// filled yet.
+bool MeshStore::fitsIn(const size_t fileSize) const {
+	const MeshStoreHeader* header = this->header();
+	if (header->arrayCount == 0 || header->arrayCount > MESH_STORE_ARRAYS)
+		return false;
+	for (size_t i = 0; i < header->arrayCount; ++i) {
+		const size_t limit = i + 1 < header->arrayCount ? fileSize : header->capacity;
+		if (header->offsets[i] < sizeof(MeshStoreHeader) || header->offsets[i] > limit || header->sizes[i] > limit - header->offsets[i])
+			return false;
+	}
+	return true;
+}
+
+// Older versions of the same file, processes that still map one keep it until they exit.
+void MeshStore::removeOlderVersions() const {
+	size_t end = sizeof(MESH_STORE_PREFIX) - 1; // On the dash of "/scop-"
+	for (int field = 0; field < 3; ++field)
+		end = this->name.find('-', end + 1);
+	const std::string prefix = this->name.substr(1, end); // scop-<user>-<device>-<inode>-
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(MESH_STORE_DIR, error)) {
+		const std::string other = entry.path().filename().string();
+		if (other.rfind(prefix, 0) == 0 && "/" + other != this->name)
+			shm_unlink(("/" + other).c_str());
+	}
+}
+
+bool MeshStore::map(const int protection) {
+	void* address = mmap(nullptr, this->length, protection, MAP_SHARED, this->fd, 0);
+	if (address == MAP_FAILED)
+		return false;
+	this->mapping = static_cast<unsigned char*>(address);
+	return true;
+}
+
+// A segment goes away with the last process that maps it: each holds a shared lock, and whoever
+// can turn its own into an exclusive one is alone.
+void MeshStore::close() {
+	if (this->owner && (!this->mapping || this->header()->state.load(std::memory_order_relaxed) == MESH_STORE_WRITING))
+		shm_unlink(this->name.c_str());
+	else if (this->locked && flock(this->fd, LOCK_EX | LOCK_NB) == 0)
+		shm_unlink(this->name.c_str());
+	if (this->mapping)
+		munmap(this->mapping, this->length);
+	if (this->fd >= 0)
+		::close(this->fd);
+	this->mapping = nullptr;
+	this->length = 0;
+	this->fd = -1;
+	this->owner = false;
+	this->locked = false;
+}
+
+MeshStoreHeader* MeshStore::header() const {
+	return reinterpret_cast<MeshStoreHeader*>(this->mapping);
+}
+
+bool MeshStore::isOpen() const {
+	return this->mapping != nullptr;
+}
+
+bool MeshStore::isOwner() const {
+	return this->owner;
+}
+
+bool MeshStore::isComplete() const {
+	return this->mapping && this->header()->state.load(std::memory_order_acquire) == MESH_STORE_COMPLETE;
+}
+
+size_t MeshStore::arrayCount() const {
+	return this->mapping ? this->header()->arrayCount : 0;
+}
+
+size_t MeshStore::size() const {
+	if (!this->mapping)
+		return 0;
+	const MeshStoreHeader* header = this->header();
+	const size_t last = header->arrayCount - 1;
+	return this->isComplete() ? header->offsets[last] + header->sizes[last] : header->offsets[last];
+}
+
+const std::string& MeshStore::getName() const {
+	return this->name;
+}
+
+MeshStore::~MeshStore() {
+	this->close();
+}
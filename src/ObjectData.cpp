@@ -4,10 +4,14 @@ static void checkFilename(const char* filename) {
 	if (filename == nullptr || filename[0] == '\0')
 		throw NoArgException();
 	const std::string file(filename);
-	if (file.size() < 5 || file.substr(file.size() - 4) != ".obj" )
+	if (file.size() < 5 || (file.substr(file.size() - 4) != ".obj" && file.substr(file.size() - 4) != ".smc"))
 		throw WrongExtensionException();
 }
 
+static bool isChunkFile(const std::string& filepath) {
+	return filepath.substr(filepath.size() - 4) == ".smc";
+}
+
 static std::string prepareFilename(const std::string& filepath) {
 	return filepath.substr(filepath.find_last_of("\\/") + 1);
 }
@@ -27,203 +31,1583 @@ static void skipCommentsAndWS(std::ifstream& file)
 	}
 }
 
-void ObjectData::getFace(std::istringstream& iss) {
-	std::vector<unsigned int> face;
-	std::string part;
-	while (iss >> part) { // Read each part of the face definition
-		std::istringstream pss(part);
-		std::string vIndexString;
-		std::getline(pss, vIndexString, '/'); // Ignore texture and normal indices
-		try {
-			face.push_back(std::stoi(vIndexString) - 1); // OBJ indices are 1-based
+// A negative OBJ index counts back from the last element read. The chunk only knows its own
+// elements, so it keeps the offset from its first one and the merge adds the chunk's base.
+static unsigned int relativeIndex(const size_t chunkCount, const int index) {
+	return static_cast<unsigned int>(static_cast<int64_t>(chunkCount) + index); // Wraps when it reaches into an earlier chunk
+}
+
+static unsigned int resolveRelative(const size_t base, const unsigned int offset) {
+	const int64_t index = static_cast<int64_t>(base) + static_cast<int32_t>(offset);
+	return index < 0 ? BEFORE_FIRST_INDEX : static_cast<unsigned int>(index);
+}
+
+// Normal index of a v/vt/vn or v//vn corner, NO_NORMAL when there is none or it does not parse.
+static unsigned int normalIndexOf(const std::string_view part, ParseChunk& chunk, bool& relative) {
+	const size_t first = part.find('/');
+	const size_t second = first == std::string_view::npos ? first : part.find('/', first + 1);
+	if (second == std::string_view::npos)
+		return NO_NORMAL;
+	const std::string_view nIndexString = part.substr(second + 1);
+	int index = 0;
+	if (std::from_chars(nIndexString.data(), nIndexString.data() + nIndexString.size(), index).ec != std::errc() || index == 0) {
+		chunk.diagnostics.add(INVALID_NORMAL_INDEX, chunk.lines, nIndexString);
+		return NO_NORMAL;
+	}
+	relative = index < 0;
+	return relative ? relativeIndex(chunk.normals.size(), index) : static_cast<unsigned int>(index - 1);
+}
+
+static void getFace(std::string_view rest, ParseChunk& chunk) {
+	std::pmr::vector<unsigned int>& face = chunk.face; // Scratch is reused across faces
+	std::pmr::vector<unsigned int>& faceNormals = chunk.faceNormals;
+	std::pmr::vector<unsigned char>& faceRelative = chunk.faceRelative;
+	face.clear();
+	faceNormals.clear();
+	faceRelative.clear();
+	bool hasNormals = false;
+	for (std::string_view part = nextToken(rest); !part.empty(); part = nextToken(rest)) { // Read each part of the face definition
+		const std::string_view vIndexString = part.substr(0, part.find('/')); // Texture indices are ignored
+		int index = 0;
+		const auto [end, error] = std::from_chars(vIndexString.data(), vIndexString.data() + vIndexString.size(), index);
+		if (error == std::errc::invalid_argument || (error == std::errc() && index == 0)) {
+			chunk.diagnostics.add(INVALID_INDEX, chunk.lines, vIndexString);
+			return;
 		}
-		catch (const std::invalid_argument& e) {
-			std::cout << YELLOW << "WARNING: Invalid vertex index: " << vIndexString << std::endl;
-			std::cout << "Line " << this->lineIndex << RESET << std::endl;
-			face.clear();
-			break;
+		if (error == std::errc::result_out_of_range) {
+			chunk.diagnostics.add(INDEX_OVERFLOW, chunk.lines, vIndexString);
+			return;
 		}
-		catch (const std::out_of_range& e) {
-			std::cout << YELLOW << "WARNING: Vertex index out of range: " << vIndexString << std::endl;
-			std::cout << "Line " << this->lineIndex << RESET << std::endl;
-			face.clear();
-			break;
+		face.push_back(index > 0 ? index - 1 : relativeIndex(chunk.vertices.size(), index)); // OBJ indices are 1-based
+		bool relativeNormal = false;
+		faceNormals.push_back(normalIndexOf(part, chunk, relativeNormal));
+		faceRelative.push_back((index < 0 ? RELATIVE_VERTEX : 0) | (relativeNormal ? RELATIVE_NORMAL : 0));
+		hasNormals |= faceNormals.back() != NO_NORMAL || relativeNormal; // A relative offset may look like NO_NORMAL
+	}
+	if (face.size() < 3) { // Ensure at least a triangle
+		chunk.diagnostics.add(SHORT_FACE, chunk.lines);
+		return;
+	}
+	const bool withNormals = hasNormals || !chunk.normalIndices.empty(); // Empty also when this is the chunk's first face
+	if (hasNormals && chunk.normalIndices.empty())
+		chunk.normalIndices.resize(chunk.faces.size(), NO_NORMAL); // Earlier faces of the chunk had none
+	const auto emit = [&](const size_t corner) {
+		if (faceRelative[corner] & RELATIVE_VERTEX)
+			chunk.relativeFaces.push_back(chunk.faces.size());
+		chunk.faces.push_back(face[corner]);
+		if (!withNormals)
+			return;
+		if (faceRelative[corner] & RELATIVE_NORMAL)
+			chunk.relativeNormals.push_back(chunk.normalIndices.size());
+		chunk.normalIndices.push_back(faceNormals[corner]);
+	};
+	for (size_t i = 1; i < face.size() - 1; ++i) { // Fan-triangulate polygons, a triangle is a fan of one
+		emit(0);
+		emit(i);
+		emit(i + 1);
+	}
+}
+
+static void parseLine(std::string_view line, ParseChunk& chunk) {
+	chunk.lines++;
+	if (line.empty() || line[0] == '#')
+		return;
+	const std::string_view type = nextToken(line);
+	if (type == "v") {	//Vertex coordinates
+		Vec3 vertex;
+		const bool x = parseFloat(line, vertex.x);
+		const bool y = parseFloat(line, vertex.y);
+		const bool z = parseFloat(line, vertex.z);
+		if (!(x && y && z))
+			chunk.diagnostics.add(MALFORMED_VERTEX, chunk.lines);
+		chunk.vertices.push_back(vertex);
+	}
+	else if (type == "vn") { //Vertex normals
+		Vec3 normal;
+		const bool x = parseFloat(line, normal.x);
+		const bool y = parseFloat(line, normal.y);
+		const bool z = parseFloat(line, normal.z);
+		if (!(x && y && z))
+			chunk.diagnostics.add(MALFORMED_NORMAL, chunk.lines);
+		chunk.normals.push_back(normal);
+	}
+	else if (type == "f") {	//Face indices
+		getFace(line, chunk);
+	}
+}
+
+// Cuts a block of whole lines at line boundaries and parses the pieces as jobs, then appends
+// them in file order so indices, line numbers and warnings come out as with a serial parse.
+// Relative indices are resolved there, once the elements before each chunk are counted.
+void ObjectData::parseBlock(const std::string_view block, std::pmr::vector<ParseChunk>& chunks) {
+	const size_t count = parallelChunkCount(block.size(), PARSE_MIN_CHUNK);
+	if (chunks.size() < count)
+		chunks.resize(count);
+	std::pmr::vector<size_t> cuts(count + 1, block.size(), chunks.get_allocator());
+	cuts[0] = 0;
+	for (size_t c = 1; c < count; ++c) {
+		const size_t newline = block.find('\n', std::max(cuts[c - 1], c * block.size() / count));
+		cuts[c] = newline == std::string_view::npos ? block.size() : newline + 1;
+	}
+	parallelFor(count, 1, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t c = begin; c < end; ++c) {
+			ParseChunk& chunk = chunks[c];
+			chunk.vertices.clear();
+			chunk.normals.clear();
+			chunk.faces.clear();
+			chunk.normalIndices.clear();
+			chunk.relativeFaces.clear();
+			chunk.relativeNormals.clear();
+			chunk.diagnostics.clear();
+			chunk.lines = 0;
+			forEachLineOf(block.substr(cuts[c], cuts[c + 1] - cuts[c]), [&](const std::string_view line) { parseLine(line, chunk); });
+		}
+	});
+	for (size_t c = 0; c < count; ++c) {
+		const ParseChunk& chunk = chunks[c];
+		const size_t corner = this->faces.size();
+		const size_t vertexBase = this->vertices.size();
+		const size_t normalBase = this->normals.size();
+		this->diagnostics.merge(chunk.diagnostics, this->lineIndex);
+		if (!chunk.normalIndices.empty() || !this->normalIndices.empty()) { // Padded so both stay parallel to faces
+			this->normalIndices.resize(this->faces.size(), NO_NORMAL);
+			this->normalIndices.insert(this->normalIndices.end(), chunk.normalIndices.begin(), chunk.normalIndices.end());
+			this->normalIndices.resize(this->faces.size() + chunk.faces.size(), NO_NORMAL);
+		}
+		this->normals.insert(this->normals.end(), chunk.normals.begin(), chunk.normals.end());
+		this->vertices.insert(this->vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+		this->faces.insert(this->faces.end(), chunk.faces.begin(), chunk.faces.end());
+		for (const size_t i : chunk.relativeFaces)
+			this->faces[corner + i] = resolveRelative(vertexBase, this->faces[corner + i]);
+		for (const size_t i : chunk.relativeNormals)
+			this->normalIndices[corner + i] = resolveRelative(normalBase, this->normalIndices[corner + i]);
+		this->lineIndex += chunk.lines;
+	}
+}
+
+struct BoundsPartial {
+	float min[3] = {+INFINITY, +INFINITY, +INFINITY};
+	float max[3] = {-INFINITY, -INFINITY, -INFINITY};
+	double sum[3] = {0.0, 0.0, 0.0};
+	float maxRadiusSq = 0.0f;
+};
+
+// Min, max and sum of one SoA component, kept in SIMD_LANES independent accumulators so the
+// loop vectorizes. Sums are flushed to double every block to keep the centroid exact on big meshes.
+static void reduceComponent(const float* values, const size_t count, float& min, float& max, double& sum) {
+	constexpr size_t BLOCK = 4096;
+	float laneMin[SIMD_LANES], laneMax[SIMD_LANES];
+	std::fill_n(laneMin, SIMD_LANES, min);
+	std::fill_n(laneMax, SIMD_LANES, max);
+	size_t i = 0;
+	while (i + SIMD_LANES <= count) {
+		float laneSum[SIMD_LANES] = {};
+		const size_t blockEnd = std::min(count - count % SIMD_LANES, i + BLOCK);
+		for (; i < blockEnd; i += SIMD_LANES) {
+			for (size_t l = 0; l < SIMD_LANES; ++l) {
+				laneMin[l] = std::min(laneMin[l], values[i + l]);
+				laneMax[l] = std::max(laneMax[l], values[i + l]);
+				laneSum[l] += values[i + l];
+			}
 		}
+		for (const float s : laneSum)
+			sum += s;
 	}
-	if (face.size() == 3) {
-		this->faces.insert(this->faces.end(), face.begin(), face.end()); // Directly add triangle indices
+	for (; i < count; ++i) {
+		laneMin[0] = std::min(laneMin[0], values[i]);
+		laneMax[0] = std::max(laneMax[0], values[i]);
+		sum += values[i];
 	}
-	else if (face.size() < 3) { // Ensure at least a triangle
-		std::cout << YELLOW << "WARNING: Face with less than 3 vertices found, skipping." << std::endl;
-		std::cout << "Line " << this->lineIndex << RESET << std::endl;
+	min = *std::min_element(laneMin, laneMin + SIMD_LANES);
+	max = *std::max_element(laneMax, laneMax + SIMD_LANES);
+}
+
+// Largest squared distance to the origin, the positions are already centered when this runs.
+static float reduceRadiusSq(const float* x, const float* y, const float* z, const size_t count) {
+	float laneMax[SIMD_LANES] = {};
+	size_t i = 0;
+	for (; i + SIMD_LANES <= count; i += SIMD_LANES) {
+		for (size_t l = 0; l < SIMD_LANES; ++l)
+			laneMax[l] = std::max(laneMax[l], x[i + l] * x[i + l] + y[i + l] * y[i + l] + z[i + l] * z[i + l]);
+	}
+	for (; i < count; ++i)
+		laneMax[0] = std::max(laneMax[0], x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+	return *std::max_element(laneMax, laneMax + SIMD_LANES);
+}
+
+// AABB, centroid and bounding sphere over an SoA copy of the positions. The first sweep
+// transposes each chunk and reduces it, the second re-centers the vertices and measures the
+// radius from the centroid in the same pass.
+void ObjectData::computeBounds() {
+	const size_t count = this->vertices.size();
+	std::vector<float> soa[3];
+	for (auto& component : soa)
+		component.resize(count);
+	std::vector<BoundsPartial> partials(parallelChunkCount(count, BOUNDS_MIN_CHUNK));
+
+	parallelFor(count, BOUNDS_MIN_CHUNK, [&](const size_t begin, const size_t end, const size_t chunk) {
+		for (size_t i = begin; i < end; ++i) {
+			soa[0][i] = this->vertices[i].x;
+			soa[1][i] = this->vertices[i].y;
+			soa[2][i] = this->vertices[i].z;
+		}
+		BoundsPartial& partial = partials[chunk];
+		for (int c = 0; c < 3; ++c)
+			reduceComponent(&soa[c][begin], end - begin, partial.min[c], partial.max[c], partial.sum[c]);
+	});
+	BoundsPartial total;
+	for (const BoundsPartial& partial : partials) {
+		for (int c = 0; c < 3; ++c) {
+			total.min[c] = std::min(total.min[c], partial.min[c]);
+			total.max[c] = std::max(total.max[c], partial.max[c]);
+			total.sum[c] += partial.sum[c];
+		}
 	}
-	else { // Handle polygons with more than 3 vertices
-		// Triangulate the polygon
-		for (size_t i = 1; i < face.size() - 1; ++i) {
-			std::vector triangle = {face[0], face[i], face[i + 1]};
-			this->faces.insert(this->faces.end(), triangle.begin(), triangle.end());
+	this->center = Vec3(static_cast<float>(total.sum[0] / static_cast<double>(count)),
+		static_cast<float>(total.sum[1] / static_cast<double>(count)),
+		static_cast<float>(total.sum[2] / static_cast<double>(count))); // Average to find the center
+
+	parallelFor(count, BOUNDS_MIN_CHUNK, [&](const size_t begin, const size_t end, const size_t chunk) {
+		const float offset[3] = {this->center.x, this->center.y, this->center.z};
+		for (int c = 0; c < 3; ++c) {
+			float* values = soa[c].data();
+			for (size_t i = begin; i < end; ++i)
+				values[i] -= offset[c];
 		}
+		for (size_t i = begin; i < end; ++i)
+			this->vertices[i] = Vec3(soa[0][i], soa[1][i], soa[2][i]); // Center the vertices around the origin
+		partials[chunk].maxRadiusSq = reduceRadiusSq(&soa[0][begin], &soa[1][begin], &soa[2][begin], end - begin);
+	});
+	float maxRadiusSq = 0.0f;
+	for (const BoundsPartial& partial : partials)
+		maxRadiusSq = std::max(maxRadiusSq, partial.maxRadiusSq);
+	this->maxDistance = std::sqrt(maxRadiusSq);
+
+	this->minX = total.min[0] - this->center.x; // Bounds are kept in the re-centered space used for UVs
+	this->maxX = total.max[0] - this->center.x;
+	this->minY = total.min[1] - this->center.y;
+	this->maxY = total.max[1] - this->center.y;
+	this->minZ = total.min[2] - this->center.z;
+	this->maxZ = total.max[2] - this->center.z;
+}
+
+// Projects one block of gathered corners with every mode. The loops only touch contiguous
+// scratch arrays so the planar and box paths vectorize, the wrapped ones go through libm.
+static void projectBlock(const ProjectionSetup& p, const float* x, const float* y, const float* z,
+	const unsigned char* axis, const size_t count, Vec2* out[PROJECTION_COUNT]) {
+	for (size_t i = 0; i < count; ++i)
+		out[PLANAR][i] = projectPlanar(p, y[i], z[i]);
+	for (size_t i = 0; i < count; ++i) { // Drop the dominant axis of the triangle normal
+		const float a = axis[i] == 0 ? z[i] - p.min[2] : x[i] - p.min[0];
+		const float b = axis[i] == 1 ? z[i] - p.min[2] : y[i] - p.min[1];
+		out[BOX][i] = Vec2(a, b);
+	}
+	for (size_t i = 0; i < count; ++i) {
+		const float around = std::atan2(z[i], x[i]) * static_cast<float>(0.5 / M_PI) + 0.5f;
+		const float radius = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+		const float polar = radius > 0.0f ? std::acos(std::clamp(y[i] / radius, -1.0f, 1.0f)) * static_cast<float>(1.0 / M_PI) : 0.5f;
+		out[CYLINDRICAL][i] = Vec2(around * p.repeats, (y[i] - p.min[1]) * p.invRange[1] * p.repeats);
+		out[SPHERICAL][i] = Vec2(around * p.repeats, polar * p.repeats * 0.5f);
 	}
 }
 
-void ObjectData::computeCenter() {
-	for (const auto& vertex : this->vertices) {
-		this->center = vertex + this->center;
+// Maps every vertex to the lowest index vertex within tolerance of it. A vertex only looks at
+// lower indices, which are already resolved when the ordered pass reaches it, so chains of
+// near-identical positions collapse onto one. Returns the number of vertices welded away.
+static size_t weldVertices(const std::vector<Vec3>& vertices, std::vector<unsigned int>& remap) {
+	const size_t count = vertices.size();
+	std::vector<BoundsPartial> partials(parallelChunkCount(count, BOUNDS_MIN_CHUNK));
+	parallelFor(count, BOUNDS_MIN_CHUNK, [&](const size_t begin, const size_t end, const size_t chunk) {
+		BoundsPartial& partial = partials[chunk];
+		for (size_t i = begin; i < end; ++i) {
+			const float p[3] = {vertices[i].x, vertices[i].y, vertices[i].z};
+			for (int c = 0; c < 3; ++c) {
+				partial.min[c] = std::min(partial.min[c], p[c]);
+				partial.max[c] = std::max(partial.max[c], p[c]);
+			}
+		}
+	});
+	BoundsPartial total;
+	for (const BoundsPartial& partial : partials) {
+		for (int c = 0; c < 3; ++c) {
+			total.min[c] = std::min(total.min[c], partial.min[c]);
+			total.max[c] = std::max(total.max[c], partial.max[c]);
+		}
 	}
-	this->center /= static_cast<float>(this->vertices.size()); // Average to find the center
-	for (auto& vertex : this->vertices) {
-		vertex = vertex - this->center; // Center the vertices around the origin
+	const Vec3 min(total.min[0], total.min[1], total.min[2]);
+	const float tolerance = (Vec3(total.max[0], total.max[1], total.max[2]) - min).length() * WELD_TOLERANCE;
+	remap.resize(count);
+	if (!(tolerance > 0.0f)) { // A single point, or NaN coordinates
+		for (size_t i = 0; i < count; ++i)
+			remap[i] = static_cast<unsigned int>(i);
+		return 0;
 	}
+	const SpatialHash hash(vertices, min, tolerance);
+	const float toleranceSq = tolerance * tolerance;
+	parallelFor(count, BOUNDS_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t i = begin; i < end; ++i) {
+			auto target = static_cast<unsigned int>(i);
+			hash.forEachNear(i, [&](const uint32_t j) {
+				const Vec3 d = vertices[j] - vertices[i];
+				if (j < target && Vec3::dot(d, d) <= toleranceSq)
+					target = j;
+			});
+			remap[i] = target;
+		}
+	});
+	size_t welded = 0;
+	for (size_t i = 0; i < count; ++i) {
+		remap[i] = remap[remap[i]];
+		welded += remap[i] != i;
+	}
+	return welded;
 }
 
-void ObjectData::computeAttributes() {
-	for (unsigned int i = 0; i < this->faces.size(); i += 3) {
-		const float shade = (i / 3 % 10) / 10.0f;
-		constexpr float angle = -M_PI / 2.0f;
+struct TriangleKey {
+	unsigned int corners[3]; // Rotated to start at the smallest, so rotations compare equal but a flipped back face does not
+	uint32_t triangle;
+};
+
+static bool sameCorners(const TriangleKey& a, const TriangleKey& b) {
+	return a.corners[0] == b.corners[0] && a.corners[1] == b.corners[1] && a.corners[2] == b.corners[2];
+}
+
+// Runs before anything is derived from the faces. Indices past the vertex list are rejected
+// here instead of halfway through attribute generation, then near-identical positions are
+// welded and triangles that are lines, points, or repeats of an earlier one with the same
+// winding are dropped, as they would be rasterized every frame for nothing. A twin facing the
+// other way is the back of a double-sided surface and stays.
+void ObjectData::validateMesh() {
+	const size_t vertexCount = this->vertices.size();
+	const size_t triangles = this->faces.size() / 3;
+	std::atomic<size_t> firstInvalid = SIZE_MAX;
+	parallelFor(this->faces.size(), ATTRIB_MIN_CHUNK * 3, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t c = begin; c < end; ++c) {
+			if (this->faces[c] < vertexCount)
+				continue;
+			size_t seen = firstInvalid.load(std::memory_order_relaxed);
+			while (c < seen && !firstInvalid.compare_exchange_weak(seen, c, std::memory_order_relaxed))
+				;
+			break;
+		}
+	});
+	if (firstInvalid != SIZE_MAX && this->faces[firstInvalid] == BEFORE_FIRST_INDEX)
+		throw RuntimeException("ERROR: Triangle " + std::to_string(firstInvalid / 3 + 1) + " uses a relative vertex index reaching before the first vertex.");
+	if (firstInvalid != SIZE_MAX) {
+		throw RuntimeException("ERROR: Triangle " + std::to_string(firstInvalid / 3 + 1) + " uses vertex "
+			+ std::to_string(static_cast<size_t>(this->faces[firstInvalid]) + 1) + " but the file only has "
+			+ std::to_string(vertexCount) + " vertices.");
+	}
+
+	std::atomic<size_t> droppedNormals = 0;
+	parallelFor(this->normalIndices.size(), ATTRIB_MIN_CHUNK * 3, [&](const size_t begin, const size_t end, size_t) {
+		size_t dropped = 0;
+		for (size_t c = begin; c < end; ++c) {
+			if (this->normalIndices[c] != NO_NORMAL && this->normalIndices[c] >= this->normals.size()) {
+				this->normalIndices[c] = NO_NORMAL; // Generated instead
+				dropped++;
+			}
+		}
+		droppedNormals += dropped;
+	});
+	this->normalStats.droppedReferences = droppedNormals;
+
+	RepairStats& stats = this->repairStats;
+	stats = RepairStats{};
+	stats.inputTriangles = triangles;
+	std::vector<unsigned int> remap;
+	stats.weldedVertices = weldVertices(this->vertices, remap);
+
+	std::vector<unsigned char> keep(triangles);
+	std::vector<TriangleKey> keys(triangles);
+	std::atomic<size_t> degenerate = 0;
+	parallelFor(triangles, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		size_t dropped = 0;
+		for (size_t t = begin; t < end; ++t) {
+			unsigned int* corner = &this->faces[t * 3];
+			for (int j = 0; j < 3; ++j)
+				corner[j] = remap[corner[j]];
+			const Vec3& a = this->vertices[corner[0]];
+			const Vec3& b = this->vertices[corner[1]];
+			const Vec3& c = this->vertices[corner[2]];
+			const float longestSq = std::max({Vec3::dot(b - a, b - a), Vec3::dot(c - b, c - b), Vec3::dot(a - c, a - c)});
+			const bool line = corner[0] == corner[1] || corner[1] == corner[2] || corner[0] == corner[2]
+				|| Vec3::cross(b - a, c - a).length() <= DEGENERATE_TOLERANCE * longestSq; // Twice the area is longest edge * height
+			keep[t] = !line;
+			dropped += line;
+			TriangleKey& key = keys[t];
+			const int first = static_cast<int>(std::min_element(corner, corner + 3) - corner);
+			for (int j = 0; j < 3; ++j)
+				key.corners[j] = corner[(first + j) % 3];
+			key.triangle = static_cast<uint32_t>(t);
+		}
+		degenerate += dropped;
+	});
+	stats.degenerateTriangles = degenerate;
+
+	parallelSort(keys, ATTRIB_MIN_CHUNK, [](const TriangleKey& a, const TriangleKey& b) {
 		for (int j = 0; j < 3; ++j) {
-			const unsigned int index = this->faces[i + j];
-			if (index >= this->vertices.size()) {
-                throw RuntimeException("ERROR: Vertex index out of range in face definition.");
-            }
-			const Vec3 vertex = this->vertices[index];
-			VertexAttrib attrib;
-			attrib.position = vertex;
-			attrib.color = Vec3(shade, shade, shade);
+			if (a.corners[j] != b.corners[j])
+				return a.corners[j] < b.corners[j];
+		}
+		return a.triangle < b.triangle;
+	});
+	std::atomic<size_t> duplicates = 0;
+	parallelFor(triangles, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		size_t dropped = 0;
+		for (size_t k = std::max<size_t>(begin, 1); k < end; ++k) {
+			if (sameCorners(keys[k], keys[k - 1]) && keep[keys[k].triangle]) { // The earliest of a run stays
+				keep[keys[k].triangle] = false;
+				dropped++;
+			}
+		}
+		duplicates += dropped;
+	});
+	stats.duplicateTriangles = duplicates;
+	if (stats.degenerateTriangles + stats.duplicateTriangles == 0)
+		return;
+
+	std::vector<size_t> offsets(parallelChunkCount(triangles, ATTRIB_MIN_CHUNK) + 1, 0);
+	parallelFor(triangles, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, const size_t chunk) {
+		offsets[chunk + 1] = static_cast<size_t>(std::count(keep.begin() + begin, keep.begin() + end, 1));
+	});
+	for (size_t chunk = 1; chunk < offsets.size(); ++chunk)
+		offsets[chunk] += offsets[chunk - 1];
+	if (offsets.back() == 0)
+		throw RuntimeException("ERROR: Every face of the OBJ file is degenerate.");
+	const bool hasNormals = !this->normalIndices.empty();
+	std::vector<unsigned int> faces(offsets.back() * 3);
+	std::vector<unsigned int> normalIndices(hasNormals ? faces.size() : 0);
+	parallelFor(triangles, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, const size_t chunk) {
+		size_t out = offsets[chunk] * 3;
+		for (size_t t = begin; t < end; ++t) {
+			if (keep[t]) {
+				std::copy_n(&this->faces[t * 3], 3, &faces[out]);
+				if (hasNormals)
+					std::copy_n(&this->normalIndices[t * 3], 3, &normalIndices[out]);
+				out += 3;
+			}
+		}
+	});
+	this->faces.swap(faces);
+	this->normalIndices.swap(normalIndices);
+}
+
+// One normal per corner. Corners with a vn reference keep the file normal, the others average
+// the faces around their vertex weighted by area and by the angle at the vertex, skipping faces
+// more than NORMAL_CREASE_ANGLE away from their own so hard edges stay hard. Each corner gathers
+// from a vertex to corners table instead of scattering into the vertex, so no two jobs write
+// the same normal.
+void ObjectData::computeNormals() {
+	const auto start = std::chrono::steady_clock::now();
+	const size_t corners = this->faces.size();
+	const size_t triangles = corners / 3;
+	const bool hasNormals = !this->normalIndices.empty();
+	const auto fromFile = [&](const size_t corner) { return hasNormals && this->normalIndices[corner] != NO_NORMAL; };
+	std::vector<Vec3> faceNormals(triangles); // Unit length
+	std::vector<float> weights(corners); // Twice the face area times the corner angle
+	std::atomic<size_t> fileCorners = 0;
+	parallelFor(triangles, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		size_t read = 0;
+		for (size_t t = begin; t < end; ++t) {
+			const Vec3& a = this->vertices[this->faces[t * 3]];
+			const Vec3& b = this->vertices[this->faces[t * 3 + 1]];
+			const Vec3& c = this->vertices[this->faces[t * 3 + 2]];
+			const Vec3 edges[3] = {b - a, c - b, a - c}; // Edge j leaves corner j
+			const Vec3 n = Vec3::cross(edges[0], -edges[2]);
+			const float area = n.length();
+			faceNormals[t] = n * (1.0f / area); // Degenerate triangles were dropped by validateMesh
+			float inverseLengths[3];
+			for (int j = 0; j < 3; ++j)
+				inverseLengths[j] = 1.0f / edges[j].length();
+			for (int j = 0; j < 3; ++j) {
+				const int previous = (j + 2) % 3;
+				const float cosAngle = -Vec3::dot(edges[j], edges[previous]) * inverseLengths[j] * inverseLengths[previous];
+				weights[t * 3 + j] = area * std::acos(std::clamp(cosAngle, -1.0f, 1.0f));
+				read += fromFile(t * 3 + j);
+			}
+		}
+		fileCorners += read;
+	});
 
-			const float scale = std::max(this->maxY - this->minY, this->maxZ - this->minZ);
-			float u = (vertex.y - this->minY) / (this->maxY - this->minY) * scale;
-			float v = (vertex.z - this->minZ) / (this->maxZ - this->minZ) * scale;
+	struct Contribution {
+		Vec3 normal; // Of the face the corner belongs to
+		float weight;
+	};
+	std::vector<unsigned int> cornerStart; // Corners of vertex v are vertexCorners[cornerStart[v], cornerStart[v + 1])
+	std::vector<Contribution> vertexCorners; // Copied in vertex order so every gather below reads one contiguous run
+	if (fileCorners < corners) { // Counting sort, one streaming pass each way
+		cornerStart.assign(this->vertices.size() + 1, 0);
+		for (const unsigned int vertex : this->faces)
+			cornerStart[vertex + 1]++;
+		for (size_t v = 0; v < this->vertices.size(); ++v)
+			cornerStart[v + 1] += cornerStart[v];
+		std::vector<unsigned int> fill(cornerStart.begin(), cornerStart.end() - 1);
+		vertexCorners.resize(corners);
+		for (size_t c = 0; c < corners; ++c)
+			vertexCorners[fill[this->faces[c]]++] = {faceNormals[c / 3], weights[c]};
+	}
 
-			float uCentered = u - 0.5f;
-			float vCentered = v - 0.5f;
-			float uRotated = uCentered * std::cos(angle) - vCentered * std::sin(angle);
-			float vRotated = uCentered * std::sin(angle) + vCentered * std::cos(angle);
-			u = uRotated + 0.5f;
-			v = vRotated + 0.5f;
+	const float creaseCos = std::cos(NORMAL_CREASE_ANGLE * static_cast<float>(M_PI) / 180.0f);
+	this->packedNormals.resize(corners);
+	parallelFor(triangles, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t c = begin * 3; c < end * 3; ++c) {
+			if (fromFile(c)) {
+				this->packedNormals[c] = packNormal(Vec3::normalize(this->normals[this->normalIndices[c]]));
+				continue;
+			}
+			const Vec3& own = faceNormals[c / 3];
+			Vec3 sum;
+			const unsigned int vertex = this->faces[c];
+			for (unsigned int k = cornerStart[vertex]; k < cornerStart[vertex + 1]; ++k) {
+				const Contribution& other = vertexCorners[k];
+				if (Vec3::dot(other.normal, own) >= creaseCos)
+					sum += other.normal * other.weight;
+			}
+			this->packedNormals[c] = packNormal(sum.length() > 0.0f ? Vec3::normalize(sum) : own);
+		}
+	});
+	std::vector<Vec3>().swap(this->normals);
+	std::vector<unsigned int>().swap(this->normalIndices);
+	this->normalStats.fileCorners = fileCorners;
+	this->normalStats.generatedCorners = corners - fileCorners;
+	this->normalStats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
-			attrib.texCoord = Vec2(u, v);
+void ObjectData::computeAttributes() {
+	const size_t cornerCount = this->faces.size();
+	const float boundsMin[3] = {this->minX, this->minY, this->minZ};
+	const float boundsMax[3] = {this->maxX, this->maxY, this->maxZ};
+	const ProjectionSetup setup = makeProjectionSetup(boundsMin, boundsMax);
+	VertexQuantization& q = this->quantization;
+	q.positionOffset = Vec3((this->minX + this->maxX) / 2.0f, (this->minY + this->maxY) / 2.0f, (this->minZ + this->maxZ) / 2.0f);
+	q.positionScale = Vec3(std::max((this->maxX - this->minX) / 2.0f, 1e-30f), std::max((this->maxY - this->minY) / 2.0f, 1e-30f),
+		std::max((this->maxZ - this->minZ) / 2.0f, 1e-30f));
+	const Vec3 toNormalized(1.0f / q.positionScale.x, 1.0f / q.positionScale.y, 1.0f / q.positionScale.z);
 
-			this->attributes.push_back(attrib);
-			this->indices.push_back(this->indices.size()); // Maintain a flat index for OpenGL
+	this->packedVertices.resize(cornerCount);
+	for (auto& uvs : this->texCoords)
+		uvs.resize(cornerCount);
+
+	parallelFor(cornerCount / 3, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		float x[ATTRIB_BLOCK * 3], y[ATTRIB_BLOCK * 3], z[ATTRIB_BLOCK * 3];
+		unsigned char axis[ATTRIB_BLOCK * 3];
+		for (size_t block = begin; block < end; block += ATTRIB_BLOCK) {
+			const size_t first = block * 3;
+			const size_t corners = (std::min(end, block + ATTRIB_BLOCK) - block) * 3;
+			for (size_t c = 0; c < corners; ++c) { // Gather corner positions into SoA scratch
+				const Vec3& vertex = this->vertices[this->faces[first + c]]; // Indices were checked by validateMesh
+				x[c] = vertex.x;
+				y[c] = vertex.y;
+				z[c] = vertex.z;
+				PackedVertex& packed = this->packedVertices[first + c];
+				packed.position[0] = quantizeSnorm((vertex.x - q.positionOffset.x) * toNormalized.x);
+				packed.position[1] = quantizeSnorm((vertex.y - q.positionOffset.y) * toNormalized.y);
+				packed.position[2] = quantizeSnorm((vertex.z - q.positionOffset.z) * toNormalized.z);
+			}
+			for (size_t c = 0; c < corners; c += 3) {
+				const Vec3 a(x[c], y[c], z[c]);
+				const Vec3 n = Vec3::cross(Vec3(x[c + 1], y[c + 1], z[c + 1]) - a, Vec3(x[c + 2], y[c + 2], z[c + 2]) - a);
+				const float ax = std::fabs(n.x), ay = std::fabs(n.y), az = std::fabs(n.z);
+				const unsigned char dominant = ax >= ay && ax >= az ? 0 : (ay >= az ? 1 : 2);
+				const uint8_t shade = shadeOf((first + c) / 3);
+				for (int j = 0; j < 3; ++j) {
+					axis[c + j] = dominant;
+					this->packedVertices[first + c + j].shade = shade;
+				}
+			}
+			Vec2* out[PROJECTION_COUNT];
+			for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+				out[mode] = &this->texCoords[mode][first];
+			projectBlock(setup, x, y, z, axis, corners, out);
 		}
+	});
+	this->vertexCount = static_cast<GLsizei>(cornerCount);
+	this->packTexCoords();
+}
+
+struct QuantizationPartial {
+	float uvMin[PROJECTION_COUNT][2];
+	float uvMax[PROJECTION_COUNT][2];
+	float texCoordError[PROJECTION_COUNT] = {};
+	float positionError = 0.0f;
+};
+
+// Quantizes every UV set over its own range and measures the error of both the UVs and the
+// positions written by computeAttributes. The float UVs are released afterwards.
+void ObjectData::packTexCoords() {
+	const size_t count = this->packedVertices.size();
+	VertexQuantization& q = this->quantization;
+	std::vector<QuantizationPartial> partials(parallelChunkCount(count, BOUNDS_MIN_CHUNK));
+	parallelFor(count, BOUNDS_MIN_CHUNK, [&](const size_t begin, const size_t end, const size_t chunk) {
+		QuantizationPartial& partial = partials[chunk];
+		for (int mode = 0; mode < PROJECTION_COUNT; ++mode) {
+			float minU = +INFINITY, minV = +INFINITY, maxU = -INFINITY, maxV = -INFINITY;
+			for (size_t i = begin; i < end; ++i) {
+				const Vec2 uv = this->texCoords[mode][i];
+				minU = std::min(minU, uv.u);
+				maxU = std::max(maxU, uv.u);
+				minV = std::min(minV, uv.v);
+				maxV = std::max(maxV, uv.v);
+			}
+			partial.uvMin[mode][0] = minU;
+			partial.uvMin[mode][1] = minV;
+			partial.uvMax[mode][0] = maxU;
+			partial.uvMax[mode][1] = maxV;
+		}
+	});
+	for (int mode = 0; mode < PROJECTION_COUNT; ++mode) {
+		for (int axis = 0; axis < 2; ++axis) {
+			float min = +INFINITY, max = -INFINITY;
+			for (const QuantizationPartial& partial : partials) {
+				min = std::min(min, partial.uvMin[mode][axis]);
+				max = std::max(max, partial.uvMax[mode][axis]);
+			}
+			q.texCoordTransform[mode][axis] = std::max((max - min) / 2.0f, 1e-30f);
+			q.texCoordTransform[mode][axis + 2] = (min + max) / 2.0f;
+		}
+		this->packedTexCoords[mode].resize(count);
+	}
+
+	parallelFor(count, BOUNDS_MIN_CHUNK, [&](const size_t begin, const size_t end, const size_t chunk) {
+		QuantizationPartial& partial = partials[chunk];
+		for (int mode = 0; mode < PROJECTION_COUNT; ++mode) {
+			const float* t = q.texCoordTransform[mode];
+			for (size_t i = begin; i < end; ++i) {
+				const Vec2 uv = this->texCoords[mode][i];
+				PackedTexCoord& packed = this->packedTexCoords[mode][i];
+				packed.u = quantizeSnorm((uv.u - t[2]) / t[0]);
+				packed.v = quantizeSnorm((uv.v - t[3]) / t[1]);
+				const float error = std::max(std::fabs(dequantizeSnorm(packed.u) * t[0] + t[2] - uv.u),
+					std::fabs(dequantizeSnorm(packed.v) * t[1] + t[3] - uv.v));
+				partial.texCoordError[mode] = std::max(partial.texCoordError[mode], error);
+			}
+		}
+		for (size_t i = begin; i < end; ++i) {
+			const PackedVertex& packed = this->packedVertices[i];
+			const Vec3 decoded = Vec3(dequantizeSnorm(packed.position[0]) * q.positionScale.x,
+				dequantizeSnorm(packed.position[1]) * q.positionScale.y,
+				dequantizeSnorm(packed.position[2]) * q.positionScale.z) + q.positionOffset;
+			const Vec3 error = decoded - this->vertices[this->faces[i]];
+			partial.positionError = std::max({partial.positionError, std::fabs(error.x), std::fabs(error.y), std::fabs(error.z)});
+		}
+	});
+	for (const QuantizationPartial& partial : partials) {
+		q.positionError = std::max(q.positionError, partial.positionError);
+		for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+			q.texCoordError[mode] = std::max(q.texCoordError[mode], partial.texCoordError[mode]);
 	}
+	q.positionBound = std::max({q.positionScale.x, q.positionScale.y, q.positionScale.z}) / 32767.0f; // Half a step, doubled for the pre-4.2 rule
+	for (auto& uvs : this->texCoords)
+		std::vector<Vec2>().swap(uvs);
 }
 
-void ObjectData::computeUVBound()
-{
-	for (const Vec3& v : this->vertices) {
-		this->minX = std::min(this->minX, v.x);
-		this->maxX = std::max(this->maxX, v.x);
-		this->minZ = std::min(this->minZ, v.z);
-		this->maxZ = std::max(this->maxZ, v.z);
-		this->minY = std::min(this->minY, v.y);
-		this->maxY = std::max(this->maxY, v.y);
+// Inverse of a rigid modelView applied to a view space point, or to a direction when w is 0.
+static Vec3 toObjectSpace(const Mat4& modelView, const Vec3& v, const float w) {
+	const float* m = modelView.data();
+	const Vec3 p(v.x - m[12] * w, v.y - m[13] * w, v.z - m[14] * w);
+	return {m[0] * p.x + m[1] * p.y + m[2] * p.z, m[4] * p.x + m[5] * p.y + m[6] * p.z, m[8] * p.x + m[9] * p.y + m[10] * p.z};
+}
+
+// Camera position in the space of a rigid modelView.
+static Vec3 objectSpaceEye(const Mat4& modelView) {
+	return toObjectSpace(modelView, Vec3(), 1.0f);
+}
+
+static uint32_t spreadBits(uint32_t v) { // 10 bits to every third bit of 30
+	v = (v | (v << 16)) & 0x030000FF;
+	v = (v | (v << 8)) & 0x0300F00F;
+	v = (v | (v << 4)) & 0x030C30C3;
+	v = (v | (v << 2)) & 0x09249249;
+	return v;
+}
+
+// Whether the mesh is closed with a consistent winding, and which way it winds. Back faces of
+// such a mesh are always hidden behind front faces, anything else can show its inside since
+// the renderer draws both sides. Returns 1 for outward, -1 for inward and 0 otherwise.
+static int closedWinding(const std::vector<unsigned int>& faces, const std::vector<Vec3>& vertices) {
+	std::vector<uint64_t> edges(faces.size());
+	for (size_t t = 0; t < faces.size(); t += 3) {
+		for (size_t j = 0; j < 3; ++j)
+			edges[t + j] = static_cast<uint64_t>(faces[t + j]) << 32 | faces[t + (j + 1) % 3];
 	}
+	parallelSort(edges, ATTRIB_MIN_CHUNK * 3);
+	std::atomic<bool> closed = true;
+	std::vector<double> volumes(parallelChunkCount(faces.size() / 3, ATTRIB_MIN_CHUNK), 0.0);
+	parallelFor(faces.size() / 3, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, const size_t chunk) {
+		double volume = 0.0;
+		for (size_t t = begin; t < end; ++t) {
+			const Vec3& a = vertices[faces[t * 3]];
+			volume += Vec3::dot(a, Vec3::cross(vertices[faces[t * 3 + 1]], vertices[faces[t * 3 + 2]]));
+		}
+		volumes[chunk] = volume;
+		for (size_t e = begin * 3; e < end * 3 && closed.load(std::memory_order_relaxed); ++e) {
+			const uint64_t reverse = edges[e] << 32 | edges[e] >> 32;
+			const auto twin = std::lower_bound(edges.begin(), edges.end(), reverse);
+			if (twin == edges.end() || *twin != reverse || (e + 1 < edges.size() && edges[e + 1] == edges[e]))
+				closed = false;
+		}
+	});
+	double volume = 0.0;
+	for (const double v : volumes)
+		volume += v;
+	if (!closed || volume == 0.0)
+		return 0;
+	return volume > 0.0 ? 1 : -1;
 }
 
-void ObjectData::computeMaxDistance(){
-	this->maxDistance = 0.0f;
-	for (const auto& vertex : this->vertices) {
-		float distance = (vertex - this->center).length();
-		this->maxDistance = std::max(distance, this->maxDistance);
+// Reorders the triangles along a Morton curve over their centroids and cuts the result into
+// meshlets of MESHLET_TRIANGLES, each with a bounding sphere and a normal cone. Shades were
+// assigned from the original triangle index so the banding stays the same.
+void ObjectData::buildMeshlets() {
+	const size_t triangles = this->faces.size() / 3;
+	const Vec3 min(this->minX, this->minY, this->minZ);
+	const Vec3 toGrid(1023.0f / std::max(this->maxX - this->minX, 1e-30f), 1023.0f / std::max(this->maxY - this->minY, 1e-30f),
+		1023.0f / std::max(this->maxZ - this->minZ, 1e-30f));
+	std::vector<uint64_t> keys(triangles); // Morton code above the original triangle index
+	parallelFor(triangles, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t t = begin; t < end; ++t) {
+			const Vec3 centroid = (this->vertices[this->faces[t * 3]] + this->vertices[this->faces[t * 3 + 1]]
+				+ this->vertices[this->faces[t * 3 + 2]]) * (1.0f / 3.0f) - min;
+			const uint32_t code = spreadBits(static_cast<uint32_t>(centroid.x * toGrid.x))
+				| spreadBits(static_cast<uint32_t>(centroid.y * toGrid.y)) << 1 | spreadBits(static_cast<uint32_t>(centroid.z * toGrid.z)) << 2;
+			keys[t] = static_cast<uint64_t>(code) << 32 | t;
+		}
+	});
+	parallelSort(keys, ATTRIB_MIN_CHUNK);
+
+	std::vector<unsigned int> faces(this->faces.size());
+	std::vector<PackedVertex> packedVertices(this->packedVertices.size());
+	std::vector<PackedNormal> packedNormals(this->packedNormals.size());
+	std::vector<PackedTexCoord> packedTexCoords[PROJECTION_COUNT];
+	for (auto& uvs : packedTexCoords)
+		uvs.resize(this->faces.size());
+	parallelFor(triangles, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t t = begin; t < end; ++t) {
+			const size_t original = keys[t] & 0xFFFFFFFF;
+			for (size_t j = 0; j < 3; ++j) {
+				faces[t * 3 + j] = this->faces[original * 3 + j];
+				packedVertices[t * 3 + j] = this->packedVertices[original * 3 + j];
+				packedNormals[t * 3 + j] = this->packedNormals[original * 3 + j];
+				for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+					packedTexCoords[mode][t * 3 + j] = this->packedTexCoords[mode][original * 3 + j];
+			}
+		}
+	});
+	this->faces.swap(faces);
+	this->packedVertices.swap(packedVertices);
+	this->packedNormals.swap(packedNormals);
+	for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+		this->packedTexCoords[mode].swap(packedTexCoords[mode]);
+
+	this->meshlets.resize((triangles + MESHLET_TRIANGLES - 1) / MESHLET_TRIANGLES);
+	parallelFor(this->meshlets.size(), ATTRIB_MIN_CHUNK / MESHLET_TRIANGLES, [&](const size_t begin, const size_t end, size_t) {
+		Vec3 corners[MESHLET_TRIANGLES * 3];
+		for (size_t m = begin; m < end; ++m) {
+			const size_t first = m * MESHLET_TRIANGLES;
+			const size_t count = std::min<size_t>(MESHLET_TRIANGLES, triangles - first);
+			for (size_t c = 0; c < count * 3; ++c)
+				corners[c] = this->vertices[this->faces[first * 3 + c]];
+			this->meshlets[m] = computeClusterBounds(corners, count);
+		}
+	});
+	const int winding = closedWinding(this->faces, this->vertices);
+	this->closedMesh = winding != 0;
+	for (ClusterBounds& bounds : this->meshlets) {
+		if (winding == 0)
+			bounds.coneCutoff = 2.0f; // Never back-facing
+		else if (winding < 0)
+			bounds.coneAxis = bounds.coneAxis * -1.0f; // Cull what faces away from the outside
 	}
 }
 
+static bool sameAttributes(const std::vector<PackedNormal>& normals, const std::vector<PackedTexCoord> (&texCoords)[PROJECTION_COUNT],
+	const size_t a, const size_t b) {
+	for (int axis = 0; axis < 3; ++axis)
+		if (normals[a].normal[axis] != normals[b].normal[axis])
+			return false;
+	for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+		if (texCoords[mode][a].u != texCoords[mode][b].u || texCoords[mode][a].v != texCoords[mode][b].v)
+			return false;
+	return true;
+}
+
+// Turns the per corner arrays into shared vertices and an index buffer. Corners of one source
+// vertex with the same normal and UVs become one vertex. The grey is flat and read from the last
+// corner of each triangle, so every triangle is rotated to end on a vertex that already has its
+// shade or that no triangle has claimed yet. Only triangles left with neither get a copy.
+void ObjectData::indexCorners() {
+	const auto start = std::chrono::steady_clock::now();
+	const size_t corners = this->faces.size();
+	const size_t vertexTotal = this->vertices.size();
+	std::vector<unsigned int> cornerStart(vertexTotal + 1, 0); // Corners of vertex v are vertexCorners[cornerStart[v], cornerStart[v + 1])
+	for (const unsigned int vertex : this->faces)
+		cornerStart[vertex + 1]++;
+	for (size_t v = 0; v < vertexTotal; ++v)
+		cornerStart[v + 1] += cornerStart[v];
+	std::vector<unsigned int> vertexCorners(corners);
+	std::vector<unsigned int> fill(cornerStart.begin(), cornerStart.end() - 1);
+	for (size_t c = 0; c < corners; ++c)
+		vertexCorners[fill[this->faces[c]]++] = static_cast<unsigned int>(c);
+	std::vector<unsigned int>().swap(fill);
+
+	std::vector<unsigned int> representative(corners); // First corner of the same vertex with the same attributes
+	parallelFor(vertexTotal, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		std::vector<unsigned int> distinct;
+		for (size_t v = begin; v < end; ++v) {
+			distinct.clear();
+			for (unsigned int k = cornerStart[v]; k < cornerStart[v + 1]; ++k) {
+				const unsigned int corner = vertexCorners[k];
+				representative[corner] = corner;
+				for (const unsigned int other : distinct)
+					if (sameAttributes(this->packedNormals, this->packedTexCoords, corner, other)) {
+						representative[corner] = other;
+						break;
+					}
+				if (representative[corner] == corner)
+					distinct.push_back(corner);
+			}
+		}
+	});
+	std::vector<unsigned int>().swap(vertexCorners);
+	std::vector<unsigned int>().swap(cornerStart);
+
+	constexpr unsigned int NO_VERTEX = ~0u;
+	std::vector<unsigned int> vertexOf(corners, NO_VERTEX); // Output vertex of each representative corner
+	std::vector<unsigned int> sources; // Corner each output vertex copies
+	std::vector<int16_t> shades; // Claimed by the triangle it provokes, -1 while free
+	sources.reserve(corners / 4);
+	shades.reserve(corners / 4);
+	this->indices.resize(corners);
+	size_t copies = 0;
+	for (size_t t = 0; t < corners / 3; ++t) { // In draw order, neighbouring triangles claim neighbouring vertices
+		unsigned int ids[3];
+		for (size_t j = 0; j < 3; ++j) {
+			const unsigned int corner = representative[t * 3 + j];
+			if (vertexOf[corner] == NO_VERTEX) {
+				vertexOf[corner] = static_cast<unsigned int>(sources.size());
+				sources.push_back(corner);
+				shades.push_back(-1);
+			}
+			ids[j] = vertexOf[corner];
+		}
+		const int16_t shade = this->packedVertices[t * 3].shade;
+		int provoking = -1;
+		for (int j = 0; j < 3 && provoking < 0; ++j)
+			if (shades[ids[j]] == shade)
+				provoking = j;
+		for (int j = 0; j < 3 && provoking < 0; ++j)
+			if (shades[ids[j]] < 0)
+				provoking = j;
+		if (provoking < 0) {
+			provoking = 2;
+			sources.push_back(sources[ids[2]]);
+			shades.push_back(-1);
+			ids[2] = static_cast<unsigned int>(sources.size() - 1);
+			copies++;
+		}
+		shades[ids[provoking]] = shade;
+		for (int j = 0; j < 3; ++j) // Rotated, the winding is kept
+			this->indices[t * 3 + j] = ids[(provoking + 1 + j) % 3];
+	}
+	std::vector<unsigned int>().swap(vertexOf);
+	std::vector<unsigned int>().swap(representative);
+
+	const size_t count = sources.size();
+	std::vector<PackedVertex> packedVertices(count);
+	std::vector<PackedNormal> packedNormals(count);
+	std::vector<PackedTexCoord> packedTexCoords[PROJECTION_COUNT];
+	for (auto& uvs : packedTexCoords)
+		uvs.resize(count);
+	parallelFor(count, ATTRIB_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t i = begin; i < end; ++i) {
+			const unsigned int corner = sources[i];
+			packedVertices[i] = this->packedVertices[corner];
+			if (shades[i] >= 0) // A vertex no triangle provokes keeps the shade of its corner, it is never read
+				packedVertices[i].shade = static_cast<uint8_t>(shades[i]);
+			packedNormals[i] = this->packedNormals[corner];
+			for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+				packedTexCoords[mode][i] = this->packedTexCoords[mode][corner];
+		}
+	});
+	this->packedVertices.swap(packedVertices);
+	this->packedNormals.swap(packedNormals);
+	for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+		this->packedTexCoords[mode].swap(packedTexCoords[mode]);
+	this->indexStats.vertices = count;
+	this->indexStats.shadeCopies = copies;
+	this->indexStats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
 void ObjectData::load(const char* filepath) {
 	checkFilename(filepath);
 	this->filename = prepareFilename(filepath); // Extract filename from path
+	this->loadFile(filepath);
+}
 
-	std::cout << BOLD << "Loading " << this->filename << "..." << RESET << std::endl;
+// The body of load, also run on the loader thread of loadAsync. The caller has named the file
+// already: the window reads the name meanwhile, so nothing here may write it.
+void ObjectData::loadFile(const char* filepath) {
+	if (!this->headless)
+		std::cout << BOLD << "Loading " << this->filename << "..." << RESET << std::endl;
+	if (isChunkFile(filepath)) {
+		this->loadChunked(filepath);
+		return;
+	}
+	const std::string sharedName = this->shareMesh ? MeshStore::nameOf(filepath) : ""; // Taken before parsing, a later save gets its own segment
+	if (this->loadShared(sharedName))
+		return;
 	std::ifstream file(filepath);
 	if (!file.is_open())
 		throw UnableToOpenOBJException();
 
-	std::string line;
-	while (std::getline(file, line)) {
-		this->lineIndex++;
-		if (line.empty() || line[0] == '#')
-			continue;
-		std::istringstream iss(line);
-		std::string type;
-		iss >> type;
-		if (type == "v") {	//Vertex coordinates
-			Vec3 vertex;
-			iss >> vertex.x >> vertex.y >> vertex.z;
-			this->vertices.push_back(vertex);
-		}
-		else if (type == "f") {	//Face indices
-			this->getFace(iss);
-		}
-	}
+	const size_t parseStage = this->beginStage("OBJ parse");
+	const auto parseStart = std::chrono::steady_clock::now();
+	this->diagnostics.clear();
+	CountingResource heap(std::pmr::new_delete_resource()); // Blocks the arena takes from the system
+	std::pmr::monotonic_buffer_resource arena(LOAD_ARENA_SIZE, &heap);
+	CountingResource temporaries(&arena); // Every load-time temporary, released with the arena
+	std::pmr::vector<char> buffer(LOAD_BUFFER_SIZE, &temporaries);
+	std::pmr::vector<ParseChunk> chunks(&temporaries); // Parser jobs grow their vectors concurrently, the resource locks
+	forEachBlock(file, buffer, [&](const std::string_view block) {
+		this->parseBlock(block, chunks);
+		if (!this->progressive || this->faces.size() - this->publishedCorners < PREVIEW_BATCH * 3)
+			return;
+		this->publishPreview();
+		if (this->loadCancelled.load(std::memory_order_relaxed))
+			file.setstate(std::ios::failbit); // Stops before the next block
+	});
+	this->loadStats.temporaryAllocations = temporaries.getAllocations();
+	this->loadStats.temporaryBytes = temporaries.getBytes();
+	this->loadStats.heapAllocations = heap.getAllocations();
+	this->loadStats.arenaPeakBytes = heap.getPeakBytes();
 	file.close();
+	this->loadStats.parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - parseStart).count();
+	StartupTimeline::getInstance().end(parseStage);
+	if (this->loadCancelled)
+		return;
+	this->diagnostics.printSummary(this->filename);
+	if (this->progressive)
+		this->publishPreview();
 	if (this->vertices.empty() || this->faces.empty()) {
         throw RuntimeException("ERROR: No vertices or faces found in the OBJ file.");
     }
-	glEnableClientState(GL_VERTEX_ARRAY); // Enable vertex array functionality
-	this->computeCenter();
-	this->computeUVBound();
+	const size_t validateStage = this->beginStage("Validate", {"OBJ parse"});
+	this->validateMesh();
+	StartupTimeline::getInstance().end(validateStage);
+	const size_t buildStage = this->beginStage("Mesh build", {"Validate"});
+	this->computeBounds();
+	this->computeNormals();
+	const auto attributesStart = std::chrono::steady_clock::now();
 	this->computeAttributes();
-	this->computeMaxDistance();
+	this->loadStats.attributesMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - attributesStart).count();
+	this->buildMeshlets();
+	this->indexCorners();
+	this->hashBuffers();
+	if (!sharedName.empty())
+		this->publishShared(sharedName);
+	StartupTimeline::getInstance().end(buildStage);
+	if (this->headless)
+		return;
+	this->queueBvh();
 	std::cout << GREEN << BOLD << this->filename << " loaded succesfully." << RESET << std::endl;
 	std::cout << std::endl;
 	this->printInfo();
 }
 
-void ObjectData::draw() {
+// Parses on a background thread, the caller can open the window right away. update() draws
+// the batches published so far and swaps in the final mesh once the loader is done.
+void ObjectData::loadAsync(const char* filepath, const bool progressive) {
+	checkFilename(filepath);
+	this->loadStart = std::chrono::steady_clock::now();
+	if (isChunkFile(filepath)) {
+		this->load(filepath); // Only the cluster table is read, streaming already draws progressively
+		this->loaderDone = true;
+		return;
+	}
+	this->filename = prepareFilename(filepath); // The window title needs it before the loader starts
+	this->progressive = progressive;
+	this->loader = std::thread([this, path = std::string(filepath)] {
+		try {
+			this->loadFile(path.c_str());
+		}
+		catch (...) {
+			this->loaderError = std::current_exception();
+		}
+		this->loaderDone.store(true, std::memory_order_release);
+	});
+}
+
+// Loader side: gathers the triangles parsed since the last batch with the raw positions they
+// reference, together with the bounds of every vertex read so far.
+void ObjectData::publishPreview() {
+	PreviewBounds& bounds = this->previewBounds;
+	for (size_t i = bounds.vertexCount; i < this->vertices.size(); ++i) {
+		const float p[3] = {this->vertices[i].x, this->vertices[i].y, this->vertices[i].z};
+		for (int axis = 0; axis < 3; ++axis) {
+			bounds.min[axis] = std::min(bounds.min[axis], p[axis]);
+			bounds.max[axis] = std::max(bounds.max[axis], p[axis]);
+			bounds.sum[axis] += p[axis];
+		}
+	}
+	bounds.vertexCount = this->vertices.size();
+	PreviewBatch batch;
+	batch.bounds = bounds;
+	batch.corners.reserve(this->faces.size() - this->publishedCorners);
+	for (size_t corner = this->publishedCorners; corner < this->faces.size(); corner += 3) {
+		const unsigned int* triangle = &this->faces[corner];
+		if (triangle[0] >= bounds.vertexCount || triangle[1] >= bounds.vertexCount || triangle[2] >= bounds.vertexCount)
+			continue; // Forward references only show up in the final mesh
+		const uint8_t shade = shadeOf(corner / 3);
+		for (int j = 0; j < 3; ++j) {
+			const Vec3& v = this->vertices[triangle[j]];
+			batch.corners.push_back({{v.x, v.y, v.z}, shade, {0, 0, 0}});
+		}
+	}
+	this->publishedCorners = this->faces.size();
+	const std::lock_guard<std::mutex> lock(this->previewMutex);
+	this->pendingPreview.push_back(std::move(batch));
+}
+
+// Render side: uploads the published batches and grows the provisional bounds, then hands over
+// to the final mesh when the loader has finished.
+void ObjectData::pollLoader() {
+	if (!this->loader.joinable())
+		return;
+	if (this->loaderDone.load(std::memory_order_acquire)) {
+		this->loader.join();
+		if (this->loaderError)
+			std::rethrow_exception(this->loaderError);
+		this->meshToOpenGL();
+		for (const auto& [buffer, corners] : this->previewBuffers)
+			glDeleteBuffers(1, &buffer);
+		this->previewBuffers.clear();
+		this->pendingPreview.clear();
+		const double readyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->loadStart).count();
+		if (this->sharedMapMs >= 0.0)
+			std::cout << "Shared load: full mesh on screen after " << BOLD << readyMs << " ms" << RESET << std::endl << std::endl;
+		else
+			std::cout << "Progressive load: first triangles on screen after " << BOLD << this->firstTrianglesMs << " ms" << RESET
+			<< ", full mesh after " << BOLD << readyMs << " ms" << RESET << std::endl << std::endl;
+		return;
+	}
+	std::vector<PreviewBatch> batches;
+	{
+		const std::lock_guard<std::mutex> lock(this->previewMutex);
+		batches.swap(this->pendingPreview);
+	}
+	for (const PreviewBatch& batch : batches) {
+		if (!batch.corners.empty()) {
+			GLuint buffer = 0;
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(batch.corners.size() * sizeof(PreviewVertex)),
+				batch.corners.data(), GL_STATIC_DRAW);
+			this->previewBuffers.emplace_back(buffer, static_cast<GLsizei>(batch.corners.size()));
+			this->previewTriangles += batch.corners.size() / 3;
+		}
+		const PreviewBounds& b = batch.bounds;
+		if (b.vertexCount == 0)
+			continue;
+		const double count = static_cast<double>(b.vertexCount);
+		this->previewCenter = Vec3(static_cast<float>(b.sum[0] / count), static_cast<float>(b.sum[1] / count),
+			static_cast<float>(b.sum[2] / count));
+		const float c[3] = {this->previewCenter.x, this->previewCenter.y, this->previewCenter.z};
+		float farthest[3];
+		for (int axis = 0; axis < 3; ++axis)
+			farthest[axis] = std::max(std::fabs(b.min[axis] - c[axis]), std::fabs(b.max[axis] - c[axis]));
+		this->previewRadius = Vec3(farthest[0], farthest[1], farthest[2]).length(); // Farthest box corner from the centroid
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Every batch buffer is its own mesh to the render state, each one drawn once for all instances.
+void ObjectData::drawPreview(RenderState& state, const Mat4* modelViews, const size_t count) {
+	state.setInstances(modelViews, count);
+	state.enableAttributes(ATTRIB_BIT(ATTRIB_POSITION) | ATTRIB_BIT(ATTRIB_SHADE) | ATTRIB_BIT(ATTRIB_MODELVIEW));
+	glVertexAttrib2f(ATTRIB_TEXCOORD, 0.0f, 0.0f);
+	for (const auto& batch : this->previewBuffers) {
+		if (state.bindMesh(&batch)) {
+			glBindBuffer(GL_ARRAY_BUFFER, batch.first);
+			glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(PreviewVertex),
+				reinterpret_cast<const void*>(offsetof(PreviewVertex, position)));
+			glVertexAttribPointer(ATTRIB_SHADE, 1, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PreviewVertex),
+				reinterpret_cast<const void*>(offsetof(PreviewVertex, shade)));
+		}
+		state.drawArraysInstanced(0, batch.second, static_cast<GLsizei>(count));
+	}
+	if (this->firstTrianglesMs < 0.0 && this->previewTriangles > 0)
+		this->firstTrianglesMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->loadStart).count();
+}
+
+// Only the header and cluster table are read here, cluster data is paged in while drawing.
+void ObjectData::loadChunked(const char* filepath) {
+	const size_t buildStage = this->beginStage("Mesh build");
+	this->stream = std::make_unique<StreamedMesh>(filepath, this->streamBudget);
+	StartupTimeline::getInstance().end(buildStage);
+	const ChunkFileHeader& header = this->stream->getHeader();
+	VertexQuantization& q = this->quantization;
+	q.positionScale = Vec3(header.positionScale[0], header.positionScale[1], header.positionScale[2]);
+	q.positionOffset = Vec3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+	for (auto& transform : q.texCoordTransform)
+		std::copy_n(header.texCoordTransform, 4, transform); // Chunks only carry the planar projection
+	q.positionBound = std::max({q.positionScale.x, q.positionScale.y, q.positionScale.z}) / 32767.0f;
+	this->center = Vec3(header.center[0], header.center[1], header.center[2]);
+	this->maxDistance = header.radius;
+	std::cout << GREEN << BOLD << this->filename << " mapped succesfully." << RESET << std::endl;
+	std::cout << std::endl;
+	this->printInfo();
+}
+
+// Drops the CPU side of the mesh so the instance can load another file, GL objects are kept.
+void ObjectData::unload() {
+	this->cancelBvh(); // The build reads vertices and faces
+	std::vector<Vec3>().swap(this->vertices);
+	std::vector<unsigned int>().swap(this->faces);
+	std::vector<Vec3>().swap(this->normals);
+	std::vector<unsigned int>().swap(this->normalIndices);
+	std::vector<PackedVertex>().swap(this->packedVertices);
+	std::vector<PackedNormal>().swap(this->packedNormals);
+	for (int mode = 0; mode < PROJECTION_COUNT; ++mode) {
+		std::vector<Vec2>().swap(this->texCoords[mode]);
+		std::vector<PackedTexCoord>().swap(this->packedTexCoords[mode]);
+	}
+	std::vector<uint32_t>().swap(this->indices);
+	this->stream.reset();
+	this->quantization = VertexQuantization{};
+	this->loadStats = LoadStats{};
+	this->repairStats = RepairStats{};
+	this->normalStats = NormalStats{};
+	this->indexStats = IndexStats{};
+	this->previewBounds = PreviewBounds{};
+	this->publishedCorners = 0;
+	this->lineIndex = 0;
+	this->center = Vec3(0.0f, 0.0f, 0.0f);
+	this->minX = this->minY = this->minZ = +INFINITY;
+	this->maxX = this->maxY = this->maxZ = -INFINITY;
+	this->maxDistance = 0.0f;
+	this->vertexCount = 0;
+	std::vector<ClusterBounds>().swap(this->meshlets);
+	this->bvh.clear();
+	this->store.close(); // After the BVH, which may point into it
+	this->sharedMapMs = -1.0;
+	this->meshReady = false;
+}
+
+void ObjectData::update() {
+	this->pollLoader();
+	this->pollTexture();
 	if (this->showTexture && this->transitionFactor < 1.0f)
 		this->transitionFactor = std::min(1.0f, this->transitionFactor + FrameTimer::getInstance().getDeltaTime() * 0.75f);
 	else if (!this->showTexture && this->transitionFactor > 0.0f)
 		this->transitionFactor = std::max(0.0f, this->transitionFactor - FrameTimer::getInstance().getDeltaTime() * 0.75f);
-	glEnable(GL_TEXTURE_2D);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glTexCoordPointer(2, GL_FLOAT, sizeof(VertexAttrib), &this->attributes[0].texCoord);
-	
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	
-	glEnableClientState(GL_COLOR_ARRAY);
-	glColorPointer(3, GL_FLOAT, sizeof(VertexAttrib), &this->attributes[0].color);
-	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-	glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_INTERPOLATE);
-	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
-	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
-	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
-	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE2_RGB, GL_CONSTANT);
-	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND2_RGB, GL_SRC_ALPHA);
-	const GLfloat envColor[4] = {1.0f, 1.0f, 1.0f, this->transitionFactor};
-	glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, envColor);
-	
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, sizeof(VertexAttrib), &this->attributes[0].position);
-
-	glDrawElements(GL_TRIANGLES, static_cast<int>(this->indices.size()), GL_UNSIGNED_INT, this->indices.data());
-
-	glDisableClientState(GL_VERTEX_ARRAY);
-	if (this->showTexture) {
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_BLEND);
-	} else {
-		glDisableClientState(GL_COLOR_ARRAY);
+}
+
+// Takes over the buffer of the previous version of the mesh. Its content is kept when the hashes
+// match, otherwise the same buffer object is refilled.
+template <typename T>
+static GLuint adoptBuffer(GLuint& previous, const uint64_t previousHash, const uint64_t hash, const T* data, const size_t count,
+	UploadStats& stats) {
+	GLuint buffer = previous;
+	previous = 0;
+	if (buffer != 0 && hash == previousHash) {
+		stats.reusedBuffers++;
+		return buffer;
+	}
+	if (buffer == 0)
+		glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(count * sizeof(T)), data, GL_STATIC_DRAW);
+	stats.uploadedBuffers++;
+	stats.uploadedBytes += count * sizeof(T);
+	return buffer;
+}
+
+void ObjectData::meshToOpenGL(ObjectData* previous) {
+	if (this->loader.joinable())
+		return; // pollLoader uploads the mesh once the loader thread is done
+	this->meshReady = true;
+	if (this->stream)
+		return; // Clusters get their own buffers when they become resident
+	const size_t uploadStage = this->beginStage("Mesh upload", {"Mesh build", "Shader compile"});
+	MeshBuffers none{};
+	MeshBuffers& old = previous ? previous->buffers : none;
+	MeshBuffers& b = this->buffers;
+	this->uploadStats = UploadStats{};
+	const bool mapped = this->sharedMapMs >= 0.0; // Nothing was parsed, the arrays are in the segment
+	const auto source = [&](const auto& local, const size_t index) {
+		using T = typename std::decay_t<decltype(local)>::value_type;
+		return mapped ? std::make_pair(this->store.array<const T>(index), this->store.count<T>(index)) : std::make_pair(local.data(), local.size());
+	};
+	const auto [vertices, vertexTotal] = source(this->packedVertices, SHARED_VERTICES);
+	b.vertices = adoptBuffer(old.vertices, old.vertexHash, b.vertexHash, vertices, vertexTotal, this->uploadStats);
+	const auto [normals, normalTotal] = source(this->packedNormals, SHARED_NORMALS);
+	b.normals = adoptBuffer(old.normals, old.normalHash, b.normalHash, normals, normalTotal, this->uploadStats);
+	std::vector<PackedNormal>().swap(this->packedNormals);
+	for (int mode = 0; mode < PROJECTION_COUNT; ++mode) {
+		const auto [texCoords, texCoordTotal] = source(this->packedTexCoords[mode], SHARED_TEXCOORDS + mode);
+		b.texCoords[mode] = adoptBuffer(old.texCoords[mode], old.texCoordHashes[mode], b.texCoordHashes[mode], texCoords,
+			texCoordTotal, this->uploadStats);
+		std::vector<PackedTexCoord>().swap(this->packedTexCoords[mode]); // The GPU copy is the only one needed now
+	}
+	const auto [indices, indexTotal] = source(this->indices, SHARED_INDICES);
+	b.indices = adoptBuffer(old.indices, old.indexHash, b.indexHash, indices, indexTotal, this->uploadStats); // Bound as the element array at draw time
+	std::vector<uint32_t>().swap(this->indices);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	std::vector<PackedVertex>().swap(this->packedVertices);
+	StartupTimeline::getInstance().end(uploadStage);
+}
+
+// Loader side, before the packed arrays are uploaded and released.
+void ObjectData::hashBuffers() {
+	this->buffers.vertexHash = hashVector(this->packedVertices);
+	this->buffers.normalHash = hashVector(this->packedNormals);
+	for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+		this->buffers.texCoordHashes[mode] = hashVector(this->packedTexCoords[mode]);
+	this->buffers.indexHash = hashVector(this->indices);
+}
+
+// Another process parsed this exact file already: everything is read in place from its segment,
+// only the meshlet table is copied since culling writes next to it.
+bool ObjectData::loadShared(const std::string& name) {
+	const auto start = std::chrono::steady_clock::now();
+	if (!this->store.open(name))
+		return false;
+	const SharedMeshInfo& info = *this->store.array<const SharedMeshInfo>(SHARED_INFO);
+	if (this->store.arrayCount() != SHARED_ARRAY_COUNT || this->store.count<SharedMeshInfo>(SHARED_INFO) != 1
+		|| this->store.count<uint32_t>(SHARED_INDICES) != info.corners || this->store.count<unsigned int>(SHARED_FACES) != info.corners
+		|| this->store.count<Vec3>(SHARED_POSITIONS) != info.sourceVertices) {
+		this->store.close();
+		return false; // Parsed again rather than trusting a segment that does not add up
+	}
+	this->quantization = info.quantization;
+	this->center = info.center;
+	this->minX = info.bounds[0];
+	this->minY = info.bounds[1];
+	this->minZ = info.bounds[2];
+	this->maxX = info.bounds[3];
+	this->maxY = info.bounds[4];
+	this->maxZ = info.bounds[5];
+	this->maxDistance = info.maxDistance;
+	this->closedMesh = info.closedMesh != 0;
+	this->vertexCount = static_cast<GLsizei>(info.corners);
+	this->repairStats = info.repair;
+	this->normalStats = info.normals;
+	this->indexStats = info.indexing;
+	this->buffers.vertexHash = info.vertexHash;
+	this->buffers.normalHash = info.normalHash;
+	std::copy(std::begin(info.texCoordHashes), std::end(info.texCoordHashes), this->buffers.texCoordHashes);
+	this->buffers.indexHash = info.indexHash;
+	const ClusterBounds* meshlets = this->store.array<const ClusterBounds>(SHARED_MESHLETS);
+	this->meshlets.assign(meshlets, meshlets + this->store.count<ClusterBounds>(SHARED_MESHLETS));
+	this->sharedMapMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	this->queueBvh();
+	std::cout << GREEN << BOLD << this->filename << " mapped from shared memory." << RESET << std::endl;
+	std::cout << std::endl;
+	this->printInfo();
+	return true;
+}
+
+// Loader side, right after the mesh build. Other processes can map the mesh as soon as this
+// returns, the BVH arrays are only filled in by finishShared once the background build is done.
+void ObjectData::publishShared(const std::string& name) {
+	const size_t triangles = this->faces.size() / 3;
+	std::vector<size_t> sizes(SHARED_ARRAY_COUNT);
+	sizes[SHARED_INFO] = sizeof(SharedMeshInfo);
+	sizes[SHARED_VERTICES] = this->packedVertices.size() * sizeof(PackedVertex);
+	sizes[SHARED_NORMALS] = this->packedNormals.size() * sizeof(PackedNormal);
+	for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+		sizes[SHARED_TEXCOORDS + mode] = this->packedTexCoords[mode].size() * sizeof(PackedTexCoord);
+	sizes[SHARED_INDICES] = this->indices.size() * sizeof(uint32_t);
+	sizes[SHARED_MESHLETS] = this->meshlets.size() * sizeof(ClusterBounds);
+	sizes[SHARED_POSITIONS] = this->vertices.size() * sizeof(Vec3);
+	sizes[SHARED_FACES] = this->faces.size() * sizeof(unsigned int);
+	sizes[SHARED_BVH_TRIANGLES] = triangles * sizeof(BvhTriangle);
+	sizes[SHARED_BVH_IDS] = triangles * sizeof(uint32_t);
+	sizes[SHARED_BVH_NODES] = triangles * 2 * sizeof(BvhNode); // What Bvh::build reserves, trimmed once built
+	if (!this->store.create(name, sizes))
+		return; // Another process is publishing it, or /dev/shm is full
+	std::copy(this->packedVertices.begin(), this->packedVertices.end(), this->store.array<PackedVertex>(SHARED_VERTICES));
+	std::copy(this->packedNormals.begin(), this->packedNormals.end(), this->store.array<PackedNormal>(SHARED_NORMALS));
+	for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+		std::copy(this->packedTexCoords[mode].begin(), this->packedTexCoords[mode].end(),
+			this->store.array<PackedTexCoord>(SHARED_TEXCOORDS + mode));
+	std::copy(this->indices.begin(), this->indices.end(), this->store.array<uint32_t>(SHARED_INDICES));
+	std::copy(this->meshlets.begin(), this->meshlets.end(), this->store.array<ClusterBounds>(SHARED_MESHLETS));
+	std::copy(this->vertices.begin(), this->vertices.end(), this->store.array<Vec3>(SHARED_POSITIONS));
+	std::copy(this->faces.begin(), this->faces.end(), this->store.array<unsigned int>(SHARED_FACES));
+	SharedMeshInfo& info = *this->store.array<SharedMeshInfo>(SHARED_INFO);
+	info = SharedMeshInfo{};
+	info.quantization = this->quantization;
+	info.center = this->center;
+	const float bounds[6] = {this->minX, this->minY, this->minZ, this->maxX, this->maxY, this->maxZ};
+	std::copy(std::begin(bounds), std::end(bounds), info.bounds);
+	info.maxDistance = this->maxDistance;
+	info.closedMesh = this->closedMesh;
+	info.sourceVertices = this->vertices.size();
+	info.corners = static_cast<uint64_t>(this->vertexCount);
+	info.vertexHash = this->buffers.vertexHash;
+	info.normalHash = this->buffers.normalHash;
+	std::copy(std::begin(this->buffers.texCoordHashes), std::end(this->buffers.texCoordHashes), info.texCoordHashes);
+	info.indexHash = this->buffers.indexHash;
+	info.repair = this->repairStats;
+	info.normals = this->normalStats;
+	info.indexing = this->indexStats;
+	this->store.publish();
+	std::vector<Vec3>().swap(this->vertices); // Read from the segment from now on, as other processes do
+	std::vector<unsigned int>().swap(this->faces);
+}
+
+// Only picking needs it, the mesh upload does not wait. A mapped mesh takes the published BVH when
+// there is one by the time this runs, and builds its own from the shared positions otherwise.
+void ObjectData::queueBvh() {
+	if (this->loadCancelled)
+		return; // Being destroyed, the job would outlive this
+	this->bvhJob = JobSystem::getInstance().submitBackground([this] { // Never run whole by a thread waiting on something else
+		const bool mapped = this->sharedMapMs >= 0.0;
+		if (mapped && this->store.isComplete()) {
+			this->adoptSharedBvh();
+			return;
+		}
+		const size_t bvhStage = this->beginStage("BVH build", {"Mesh build"});
+		if (this->store.isOpen()) // Mapped or published, the positions and faces are only in the segment
+			this->bvh.build(this->store.array<const Vec3>(SHARED_POSITIONS), this->store.array<const unsigned int>(SHARED_FACES),
+				this->store.count<unsigned int>(SHARED_FACES) / 3);
+		else
+			this->bvh.build(this->vertices.data(), this->faces.data(), this->faces.size() / 3);
+		StartupTimeline::getInstance().end(bvhStage);
+		if (this->store.isOwner())
+			this->finishShared();
+	});
+}
+
+// BVH job side. From then on this process also picks against the shared copy.
+void ObjectData::finishShared() {
+	const BvhView& view = this->bvh.getView();
+	try {
+		this->store.resizeLast(view.nodeCount * sizeof(BvhNode));
+		std::copy(view.nodes, view.nodes + view.nodeCount, this->store.array<BvhNode>(SHARED_BVH_NODES));
+		std::copy(view.triangles, view.triangles + view.triangleCount, this->store.array<BvhTriangle>(SHARED_BVH_TRIANGLES));
+		std::copy(view.triangleIds, view.triangleIds + view.triangleCount, this->store.array<uint32_t>(SHARED_BVH_IDS));
+		SharedMeshInfo& info = *this->store.array<SharedMeshInfo>(SHARED_INFO);
+		info.bvhLeafCount = view.leafCount;
+		info.bvhDepth = view.depth;
+		this->store.complete();
+	}
+	catch (const std::exception& e) {
+		std::cout << YELLOW << "WARNING: The BVH of " << this->filename << " is not shared. " << e.what() << RESET << std::endl;
+		errorCode = NO_ERROR;
+		return; // The mesh itself stays published, other processes build their own
+	}
+	this->adoptSharedBvh();
+}
+
+void ObjectData::adoptSharedBvh() {
+	const SharedMeshInfo& info = *this->store.array<const SharedMeshInfo>(SHARED_INFO);
+	this->bvh.adopt({this->store.array<const BvhNode>(SHARED_BVH_NODES), this->store.count<BvhNode>(SHARED_BVH_NODES),
+		this->store.array<const BvhTriangle>(SHARED_BVH_TRIANGLES), this->store.array<const uint32_t>(SHARED_BVH_IDS),
+		this->store.count<uint32_t>(SHARED_BVH_IDS), info.bvhLeafCount, info.bvhDepth});
+}
+
+// Render side, between frames: the new version takes the buffers, texture and view settings of
+// the one it replaces, which keeps drawing until this returns.
+void ObjectData::finishReload(ObjectData& previous) {
+	const auto start = std::chrono::steady_clock::now();
+	if (this->loader.joinable())
+		this->loader.join();
+	if (this->loaderError)
+		std::rethrow_exception(this->loaderError);
+	this->textureID = previous.textureID;
+	this->texturePath = previous.texturePath;
+	this->textureHash = previous.textureHash;
+	previous.textureID = 0;
+	this->projection = this->stream ? PLANAR : previous.projection;
+	this->showTexture = previous.showTexture;
+	this->transitionFactor = previous.transitionFactor;
+	this->culling = previous.culling;
+	this->lighting = previous.lighting;
+	this->meshToOpenGL(&previous);
+	previous.releaseBuffers();
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	const UploadStats& stats = this->uploadStats;
+	std::cout << GREEN << BOLD << "Reloaded " << this->filename << RESET << ": " << stats.uploadedBuffers << " buffers uploaded ("
+		<< static_cast<double>(stats.uploadedBytes) / (1 << 20) << " MB), " << stats.reusedBuffers << " unchanged, swapped in "
+		<< ms << " ms" << std::endl;
+}
+
+// GL objects the mesh still owns, the context must be current.
+void ObjectData::releaseBuffers() {
+	glDeleteBuffers(1, &this->buffers.vertices); // Zero names are ignored
+	glDeleteBuffers(1, &this->buffers.normals);
+	glDeleteBuffers(PROJECTION_COUNT, this->buffers.texCoords);
+	glDeleteBuffers(1, &this->buffers.indices);
+	this->buffers = MeshBuffers{};
+	for (const auto& [buffer, corners] : this->previewBuffers)
+		glDeleteBuffers(1, &buffer);
+	this->previewBuffers.clear();
+	glDeleteTextures(1, &this->textureID);
+	this->textureID = 0;
+}
+
+void ObjectData::draw(RenderState& state, const ShaderProgram& shader, const Mat4& projection, const Mat4* modelViews,
+	const size_t count) {
+	const VertexQuantization& q = this->quantization;
+	if (this->meshReady) {
+		glUniform3f(shader.uniform("positionScale"), q.positionScale.x, q.positionScale.y, q.positionScale.z);
+		glUniform3f(shader.uniform("positionOffset"), q.positionOffset.x, q.positionOffset.y, q.positionOffset.z);
+		glUniform4fv(shader.uniform("texCoordTransform"), 1, q.texCoordTransform[this->projection]);
+	}
+	else { // Preview positions are raw floats
+		glUniform3f(shader.uniform("positionScale"), 1.0f, 1.0f, 1.0f);
+		glUniform3f(shader.uniform("positionOffset"), -this->previewCenter.x, -this->previewCenter.y, -this->previewCenter.z);
+		glUniform4f(shader.uniform("texCoordTransform"), 1.0f, 1.0f, 0.0f, 0.0f);
+	}
+	glUniform1f(shader.uniform("transition"), this->transitionFactor);
+	glUniform1f(shader.uniform("lighting"), this->lighting ? 1.0f : 0.0f);
+	glVertexAttrib3f(ATTRIB_NORMAL, 0.0f, 0.0f, 0.0f); // Previews and streamed clusters get faceted normals in the shader
+	state.bindTexture(this->textureID);
+	if (!this->meshReady) {
+		this->drawPreview(state, modelViews, count);
+		return;
+	}
+	if (this->stream) {
+		this->drawStream(state, modelViews, count);
+		return;
+	}
+
+	if (state.bindMesh(this))
+		this->bindBuffers();
+	const unsigned int attributes = ATTRIB_BIT(ATTRIB_POSITION) | ATTRIB_BIT(ATTRIB_SHADE) | ATTRIB_BIT(ATTRIB_NORMAL) | ATTRIB_BIT(ATTRIB_TEXCOORD);
+	if (!this->culling || this->meshlets.empty()) {
+		state.setInstances(modelViews, count);
+		state.enableAttributes(attributes | ATTRIB_BIT(ATTRIB_MODELVIEW));
+		state.drawElementsInstanced(this->vertexCount, static_cast<GLsizei>(count)); // Indices are stored in draw order
+		return;
+	}
+	this->cullMeshlets(projection, modelViews, count, count >= INSTANCED_MIN_INSTANCES);
+	if (!this->visibleModelViews.empty()) { // Whole instances, one draw for all of them
+		state.setInstances(this->visibleModelViews.data(), this->visibleModelViews.size());
+		state.enableAttributes(attributes | ATTRIB_BIT(ATTRIB_MODELVIEW));
+		state.drawElementsInstanced(this->vertexCount, static_cast<GLsizei>(this->visibleModelViews.size()));
+	}
+	state.enableAttributes(attributes);
+	for (size_t i = 0; i < count; ++i) { // Instances cut by the frustum keep their visible meshlets only
+		if (this->drawCounts[i].empty())
+			continue;
+		state.setModelView(modelViews[i]);
+		state.multiDrawElements(this->drawCounts[i].data(), this->drawOffsets[i].data(), static_cast<GLsizei>(this->drawCounts[i].size()));
+	}
+}
+
+void ObjectData::bindBuffers() const {
+	glBindBuffer(GL_ARRAY_BUFFER, this->buffers.vertices);
+	glVertexAttribPointer(ATTRIB_POSITION, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex),
+		reinterpret_cast<const void*>(offsetof(PackedVertex, position)));
+	glVertexAttribPointer(ATTRIB_SHADE, 1, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedVertex),
+		reinterpret_cast<const void*>(offsetof(PackedVertex, shade)));
+	glBindBuffer(GL_ARRAY_BUFFER, this->buffers.normals);
+	glVertexAttribPointer(ATTRIB_NORMAL, 3, GL_BYTE, GL_TRUE, sizeof(PackedNormal), nullptr);
+	glBindBuffer(GL_ARRAY_BUFFER, this->buffers.texCoords[this->projection]);
+	glVertexAttribPointer(ATTRIB_TEXCOORD, 2, GL_SHORT, GL_TRUE, sizeof(PackedTexCoord), nullptr);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->buffers.indices);
+}
+
+// Residency follows the first instance, seen from anywhere else every cluster may face the camera.
+void ObjectData::drawStream(RenderState& state, const Mat4* modelViews, const size_t count) {
+	this->stream->update(objectSpaceEye(modelViews[0]), count == 1);
+	state.setInstances(modelViews, count);
+	state.bindMesh(this->stream.get()); // Clusters point the attributes at their own buffers
+	state.enableAttributes(ATTRIB_BIT(ATTRIB_POSITION) | ATTRIB_BIT(ATTRIB_SHADE) | ATTRIB_BIT(ATTRIB_TEXCOORD) | ATTRIB_BIT(ATTRIB_MODELVIEW));
+	this->stream->draw(state, count);
+}
+
+// Tests every meshlet of every instance against the view frustum and its normal cone, in object
+// space so the bounds never need transforming. Instances are split across jobs. With batchInside,
+// instances entirely in the frustum skip the meshlet tests and go to visibleModelViews instead.
+void ObjectData::cullMeshlets(const Mat4& projection, const Mat4* modelViews, const size_t count, const bool batchInside) {
+	if (this->drawOffsets.size() < count) {
+		this->drawOffsets.resize(count);
+		this->drawCounts.resize(count);
+	}
+	this->instanceFrustumCulled.assign(count, 0);
+	this->instanceConeCulled.assign(count, 0);
+	this->instanceBatched.assign(count, 0);
+	const size_t triangles = static_cast<size_t>(this->vertexCount) / 3;
+	parallelFor(count, CULL_MIN_INSTANCES, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t i = begin; i < end; ++i) {
+			std::vector<const void*>& offsets = this->drawOffsets[i];
+			std::vector<GLsizei>& counts = this->drawCounts[i];
+			offsets.clear();
+			counts.clear();
+			const Frustum frustum = extractFrustum(projection * modelViews[i]);
+			const FrustumTest whole = testSphere(frustum, Vec3(), this->maxDistance);
+			if (whole == OUTSIDE) {
+				this->instanceFrustumCulled[i] = this->meshlets.size();
+				continue;
+			}
+			if (whole == INSIDE && batchInside) {
+				this->instanceBatched[i] = 1;
+				continue;
+			}
+			const Vec3 eye = objectSpaceEye(modelViews[i]);
+			size_t runEnd = SIZE_MAX; // First index after the last range
+			for (size_t m = 0; m < this->meshlets.size(); ++m) {
+				const ClusterBounds& bounds = this->meshlets[m];
+				if (whole == INTERSECTING && testSphere(frustum, bounds.center, bounds.radius) == OUTSIDE) {
+					this->instanceFrustumCulled[i]++;
+					continue;
+				}
+				if (isBackFacing(bounds, eye)) {
+					this->instanceConeCulled[i]++;
+					continue;
+				}
+				const size_t first = m * MESHLET_TRIANGLES * 3;
+				const auto corners = static_cast<GLsizei>(std::min<size_t>(MESHLET_TRIANGLES, triangles - m * MESHLET_TRIANGLES) * 3);
+				if (runEnd == first)
+					counts.back() += corners; // Neighbouring meshlets share one draw range
+				else {
+					offsets.push_back(reinterpret_cast<const void*>(first * sizeof(uint32_t)));
+					counts.push_back(corners);
+				}
+				runEnd = first + static_cast<size_t>(corners);
+			}
+		}
+	});
+	this->cullStats.frames++;
+	this->cullStats.tested += this->meshlets.size() * count;
+	this->visibleModelViews.clear();
+	for (size_t i = 0; i < count; ++i) {
+		this->cullStats.frustumCulled += this->instanceFrustumCulled[i];
+		this->cullStats.coneCulled += this->instanceConeCulled[i];
+		if (this->instanceBatched[i])
+			this->visibleModelViews.push_back(modelViews[i]);
 	}
 }
 
 void ObjectData::dataToOpenGL()
 {
-	glGenTextures(1, &this->textureID);
+	if (this->textureID == 0)
+		glGenTextures(1, &this->textureID);
 	glBindTexture(GL_TEXTURE_2D, this->textureID);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, this->ppmData.width, this->ppmData.height, 0, GL_RGB, GL_UNSIGNED_BYTE, this->ppmData.data);
+	int width = this->ppmData.width, height = this->ppmData.height;
+	for (size_t i = 0; i < this->ppmData.mipLevels.size(); ++i) {
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+		glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i + 1), GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, this->ppmData.mipLevels[i].data());
+	}
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->ppmData.mipLevels.empty() ? GL_LINEAR : GL_LINEAR_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	this->textureHash = this->ppmData.hash;
 
 }
 
-void ObjectData::loadPPM(const char* filepath) {
+// Decoding only touches ppmData, so it can run on any thread while the GL context is created.
+void ObjectData::decodePPM(const char* filepath) {
+	const size_t decodeStage = StartupTimeline::getInstance().begin("PPM decode"); // One texture for the scene, not scoped to a file
 	std::ifstream file(filepath, std::ios::binary);
 	if (!file.is_open()) {
 		throw UnableToOpenPPMException(filepath);
@@ -245,86 +1629,364 @@ void ObjectData::loadPPM(const char* filepath) {
 	if (maxColorValue != 255) {
 		throw WrongPPMFormatException(filepath);
 	}
+	delete[] this->ppmData.data; // A previous texture, if any
 	this->ppmData.data = new unsigned char[width * height * 3]; // Allocate memory for pixel data
 	skipCommentsAndWS(file); // Skip any remaining whitespace before reading pixel data
 	file.read(reinterpret_cast<char*>(this->ppmData.data), width * height * 3);
 	if (!file) {
 		delete[] this->ppmData.data;
+		this->ppmData.data = nullptr;
 		throw WrongPPMFormatException(filepath);
 	}
-	for (int i = 0; i < width * height * 3; i += 3) {
-		std::swap(this->ppmData.data[i + 1], this->ppmData.data[i + 2]); // swap G et B
-	}
 	this->ppmData.width = width;
 	this->ppmData.height = height;
-	this->dataToOpenGL();
-	std::cout << GREEN << BOLD << "PPM texture loaded successfully from " << filepath << RESET << std::endl;
-	std::cout << std::endl;
 	file.close();
+	this->ppmData.hash = hashBytes(this->ppmData.data, static_cast<size_t>(width) * height * 3);
+	JobSystem& jobs = JobSystem::getInstance();
+	unsigned char* pixels = this->ppmData.data;
+	JobHandle level = jobs.submit([pixels, count = static_cast<size_t>(width) * height] {
+		parallelFor(count, TEXTURE_MIN_CHUNK, [pixels](const size_t begin, const size_t end, size_t) {
+			for (size_t i = begin; i < end; ++i)
+				std::swap(pixels[i * 3 + 1], pixels[i * 3 + 2]); // swap G et B
+		});
+	});
+	this->ppmData.mipLevels.clear();
+	for (int w = width, h = height; w > 1 || h > 1; w = std::max(w / 2, 1), h = std::max(h / 2, 1))
+		this->ppmData.mipLevels.emplace_back(static_cast<size_t>(std::max(w / 2, 1)) * std::max(h / 2, 1) * 3);
+	for (size_t i = 0; i < this->ppmData.mipLevels.size(); ++i) // Each level waits for the one it is filtered from
+		level = jobs.submit([this, i] { this->buildMipLevel(i); }, {level});
+	jobs.wait(level);
+	StartupTimeline::getInstance().end(decodeStage);
 }
 
-void ObjectData::moveObject(const int control, const float speed) {
-	const float ajustedSpeed = (speed * this->maxDistance) * FrameTimer::getInstance().getDeltaTime();
-	switch (control) {
-		case RESET_POSITION:
-			this->position = Vec3(0.0f, 0.0f, 0.0f);
-			break;
-		case UP:
-			this->position.y += ajustedSpeed;
-			break;
-		case DOWN:
-			this->position.y -= ajustedSpeed;
-			break;
-		case LEFT:
-			this->position.x -= ajustedSpeed;
-			break;
-		case RIGHT:
-			this->position.x += ajustedSpeed;
-			break;
-		case FORWARD:
-			this->position.z -= ajustedSpeed;
-			break;
-		case BACKWARD:
-			this->position.z += ajustedSpeed;
-			break;
-		default:
-			break;
+void ObjectData::decodePPMAsync(const char* filepath) {
+	this->texturePath = filepath;
+	this->textureError = nullptr;
+	this->textureDecoded = false;
+	this->textureLoader = std::thread([this] {
+		try {
+			this->decodePPM(this->texturePath.c_str());
+		}
+		catch (...) {
+			this->textureError = std::current_exception();
+		}
+		this->textureDecoded.store(true, std::memory_order_release);
+	});
+}
+
+void ObjectData::reloadTexture() {
+	if (this->textureLoader.joinable())
+		return; // The decode in flight may already read the new file, the next event catches it otherwise
+	this->textureReloadStart = std::chrono::steady_clock::now();
+	this->decodePPMAsync(std::string(this->texturePath).c_str());
+}
+
+// Re-specifies the existing texture object, every mesh sharing it sees the new pixels.
+void ObjectData::pollTexture() {
+	if (!this->textureLoader.joinable() || !this->textureDecoded.load(std::memory_order_acquire))
+		return;
+	this->textureLoader.join();
+	if (this->textureError) {
+		try {
+			std::rethrow_exception(this->textureError);
+		}
+		catch (const std::exception& e) {
+			std::cout << YELLOW << "WARNING: Keeping the previous texture. " << e.what() << RESET << std::endl;
+		}
+		errorCode = NO_ERROR; // Nothing was replaced, the session goes on
+		return;
 	}
+	const bool changed = this->ppmData.hash != this->textureHash;
+	if (changed)
+		this->dataToOpenGL();
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->textureReloadStart).count();
+	std::cout << GREEN << BOLD << "Reloaded " << this->texturePath << RESET << ": " << (changed ? "uploaded" : "unchanged, nothing uploaded")
+		<< " after " << ms << " ms" << std::endl;
 }
 
+// Box-filters mip level index + 1 from the level above it, rows are split across jobs.
+void ObjectData::buildMipLevel(const size_t index) {
+	int width = this->ppmData.width, height = this->ppmData.height;
+	for (size_t i = 0; i < index; ++i) {
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+	const unsigned char* source = index == 0 ? this->ppmData.data : this->ppmData.mipLevels[index - 1].data();
+	unsigned char* target = this->ppmData.mipLevels[index].data();
+	const int targetWidth = std::max(width / 2, 1);
+	const int targetHeight = std::max(height / 2, 1);
+	parallelFor(targetHeight, TEXTURE_MIN_CHUNK / targetWidth + 1, [&](const size_t begin, const size_t end, size_t) {
+		for (int y = static_cast<int>(begin); y < static_cast<int>(end); ++y) {
+			const int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+			for (int x = 0; x < targetWidth; ++x) {
+				const int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+				for (int c = 0; c < 3; ++c) {
+					const int sum = source[(y0 * width + x0) * 3 + c] + source[(y0 * width + x1) * 3 + c]
+						+ source[(y1 * width + x0) * 3 + c] + source[(y1 * width + x1) * 3 + c];
+					target[(y * targetWidth + x) * 3 + c] = static_cast<unsigned char>((sum + 2) / 4);
+				}
+			}
+		}
+	});
+}
+
+// Joins the decode thread if there is one, the context must be current.
+void ObjectData::uploadTexture() {
+	if (this->textureLoader.joinable()) {
+		this->textureLoader.join();
+		if (this->textureError)
+			std::rethrow_exception(this->textureError);
+	}
+	const size_t uploadStage = StartupTimeline::getInstance().begin("Texture upload", {"PPM decode", "Window + GL context"});
+	this->dataToOpenGL();
+	StartupTimeline::getInstance().end(uploadStage);
+	std::cout << GREEN << BOLD << "PPM texture loaded successfully from " << this->texturePath << RESET << std::endl;
+	std::cout << std::endl;
+}
+
+void ObjectData::shareTexture(const ObjectData& owner) {
+	this->textureID = owner.textureID;
+	this->texturePath = owner.texturePath;
+}
+
+void ObjectData::loadPPM(const char* filepath) {
+	this->texturePath = filepath;
+	this->decodePPM(filepath);
+	this->uploadTexture();
+}
+
+
 void ObjectData::toggleTexture() {
 	this->showTexture = !this->showTexture;
 }
 
+void ObjectData::cycleProjection() {
+	if (this->stream) {
+		std::cout << YELLOW << "WARNING: Chunked meshes only carry the planar projection." << RESET << std::endl;
+		return;
+	}
+	this->projection = static_cast<TextureProjection>((this->projection + 1) % PROJECTION_COUNT);
+}
+
+void ObjectData::setStreamBudget(const size_t bytes) {
+	this->streamBudget = bytes;
+}
+
+void ObjectData::setDiagnosticsMode(const bool strict, const bool quiet) {
+	this->diagnostics.setMode(strict, quiet);
+}
+
+void ObjectData::setSharedStore(const bool enabled) {
+	this->shareMesh = enabled;
+}
+
+void ObjectData::setHeadless(const bool headless) {
+	this->headless = headless;
+}
+
+// Startup timeline stage scoped to this file, batch loads record none.
+size_t ObjectData::beginStage(const char* stage, const std::initializer_list<const char*> dependencies) const {
+	if (this->headless)
+		return TIMELINE_SKIPPED;
+	return StartupTimeline::getInstance().begin(stage, dependencies, this->filename);
+}
+
+void ObjectData::toggleLighting() {
+	this->lighting = !this->lighting;
+}
+
+void ObjectData::toggleCulling() {
+	this->culling = !this->culling;
+}
+
+void ObjectData::printRenderStats() const {
+	if (this->stream)
+		this->stream->printStats();
+	this->bvh.printStats();
+	const CullStats& stats = this->cullStats;
+	if (stats.tested == 0)
+		return;
+	const double tested = static_cast<double>(stats.tested);
+	std::cout << "Meshlet culling: " << stats.tested / stats.frames << " meshlets tested per frame, "
+		<< BOLD << static_cast<double>(stats.frustumCulled) / tested * 100.0 << "%" << RESET << " outside the frustum, "
+		<< BOLD << static_cast<double>(stats.coneCulled) / tested * 100.0 << "%" << RESET << " back-facing" << std::endl;
+}
+
 void ObjectData::printInfo() const {
 	std::cout << "Object file: " << this->filename << std::endl;
-	std::cout << "Vertices: " << this->vertices.size() << std::endl;
-	std::cout << "Faces: " << this->faces.size() / 3 << std::endl;
+	if (this->stream) {
+		const ChunkFileHeader& header = this->stream->getHeader();
+		std::cout << "Vertices: " << header.vertexCount << std::endl;
+		std::cout << "Faces: " << header.triangleCount << std::endl;
+		std::cout << "Clusters: " << header.clusterCount << ", GPU budget " << this->streamBudget / (1024 * 1024) << " MB" << std::endl;
+		std::cout << std::endl;
+		return;
+	}
+	const bool mapped = this->sharedMapMs >= 0.0;
+	std::cout << "Vertices: " << this->getVertexCount() << std::endl;
+	std::cout << "Faces: " << this->vertexCount / 3 << std::endl;
+	const RepairStats& repair = this->repairStats;
+	std::cout << "Repair: " << repair.weldedVertices << " vertices welded, " << repair.degenerateTriangles << " degenerate and "
+		<< repair.duplicateTriangles << " duplicate triangles dropped ("
+		<< static_cast<double>(repair.degenerateTriangles + repair.duplicateTriangles) / static_cast<double>(std::max<size_t>(repair.inputTriangles, 1)) * 100.0
+		<< "% of the input)" << std::endl;
+	const NormalStats& normals = this->normalStats;
+	std::cout << "Normals: " << normals.fileCorners << " corners from vn, " << normals.generatedCorners << " generated ("
+		<< NORMAL_CREASE_ANGLE << " degree crease) in " << normals.ms << " ms, "
+		<< static_cast<double>(normals.fileCorners + normals.generatedCorners) / std::max(normals.ms, 1e-3) / 1000.0 << " M corners/s";
+	if (normals.droppedReferences > 0)
+		std::cout << ", " << normals.droppedReferences << " vn references out of range";
+	std::cout << std::endl;
+	const IndexStats& indexing = this->indexStats;
+	const size_t vertexBytes = sizeof(PackedVertex) + sizeof(PackedNormal) + PROJECTION_COUNT * sizeof(PackedTexCoord); // Every projection is resident
+	const size_t corners = static_cast<size_t>(this->vertexCount);
+	std::cout << "Indexing: " << indexing.vertices << " vertices for " << corners << " corners, " << indexing.shadeCopies
+		<< " copied for their flat shade, in " << indexing.ms << " ms, mesh " << BOLD
+		<< static_cast<double>(indexing.vertices * vertexBytes + corners * sizeof(uint32_t)) / (1 << 20) << " MB" << RESET
+		<< " instead of " << static_cast<double>(corners * vertexBytes) / (1 << 20) << " MB unindexed" << std::endl;
+	std::cout << "Meshlets: " << this->meshlets.size() << " of up to " << MESHLET_TRIANGLES << " triangles, "
+		<< (this->closedMesh ? "closed" : "open, no backface culling") << std::endl;
+	if (mapped)
+		std::cout << "Shared memory: " << this->store.getName() << ", " << static_cast<double>(this->store.size()) / (1 << 20)
+			<< " MB mapped read-only in " << this->sharedMapMs << " ms, nothing parsed" << std::endl;
+	else if (this->store.isOwner())
+		std::cout << "Shared memory: published as " << this->store.getName() << " for other processes" << std::endl;
+	this->printLoadStats();
+	this->printQuantization();
 	std::cout << std::endl;
 }
 
-const std::string& ObjectData::getFilename() const {
-	return this->filename;
+void ObjectData::printQuantization() const {
+	static const char* projectionNames[PROJECTION_COUNT] = {"planar", "cylindrical", "spherical", "box"};
+	const VertexQuantization& q = this->quantization;
+	std::cout << "Vertex format: " << sizeof(PackedVertex) + sizeof(PackedTexCoord) + sizeof(PackedNormal) << " bytes, position error "
+		<< q.positionError << " (bound " << q.positionBound << ", "
+		<< q.positionError / std::max(this->maxDistance, 1e-30f) * 100.0f << "% of radius)" << std::endl;
+	std::cout << "UV error:";
+	for (int mode = 0; mode < PROJECTION_COUNT; ++mode)
+		std::cout << " " << projectionNames[mode] << " " << q.texCoordError[mode];
+	std::cout << std::endl;
 }
 
-const Vec3& ObjectData::getPosition() const {
-	return this->position;
+void ObjectData::printLoadStats() const {
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	const size_t triangles = std::max<size_t>(static_cast<size_t>(this->vertexCount) / 3, 1);
+	std::cout << "Load allocations: " << this->loadStats.temporaryAllocations << " temporaries ("
+		<< static_cast<double>(this->loadStats.temporaryAllocations) / static_cast<double>(triangles) << " per triangle, "
+		<< this->loadStats.temporaryBytes / 1024 << " KB), " << this->loadStats.heapAllocations << " arena blocks" << std::endl;
+	std::cout << "Peak memory: arena " << this->loadStats.arenaPeakBytes / 1024 << " KB, process "
+		<< usage.ru_maxrss / 1024 << " MB" << std::endl; // ru_maxrss is in KB on Linux
+}
+
+const std::string& ObjectData::getFilename() const {
+	return this->filename;
 }
 
 const Vec3& ObjectData::getCenter() const {
-	return this->center;
+	return this->meshReady ? this->center : this->previewCenter;
 }
 
 float ObjectData::getMaxDistance() const {
-	return this->maxDistance;
+	return this->meshReady ? this->maxDistance : this->previewRadius;
+}
+
+// Closest triangle along a view space ray over every instance. Instances are rigid, so hit
+// distances stay in view units and compare directly.
+bool ObjectData::pick(const Mat4* modelViews, const size_t count, const Vec3& origin, const Vec3& direction,
+	RayHit& hit, size_t& instance) const {
+	if (!this->meshReady)
+		return false;
+	this->waitForBvh(); // Helps with its subtree jobs, never takes the whole build
+	bool found = false;
+	for (size_t i = 0; i < count; ++i) {
+		if (this->bvh.intersect(toObjectSpace(modelViews[i], origin, 1.0f), toObjectSpace(modelViews[i], direction, 0.0f), hit)) {
+			instance = i;
+			found = true;
+		}
+	}
+	return found;
+}
+
+const Bvh& ObjectData::getBvh() const {
+	this->waitForBvh();
+	return this->bvh;
+}
+
+void ObjectData::waitForBvh() const {
+	if (this->bvhJob)
+		JobSystem::getInstance().wait(this->bvhJob);
+}
+
+// Drops a build nobody started yet instead of running it, waits for one already running.
+void ObjectData::cancelBvh() {
+	if (this->bvhJob && !JobSystem::getInstance().cancel(this->bvhJob))
+		this->waitForBvh();
+	this->bvhJob.reset();
+}
+
+bool ObjectData::isReady() const {
+	return this->meshReady;
+}
+
+bool ObjectData::isLoaded() const {
+	return this->loaderDone.load(std::memory_order_acquire);
+}
+
+bool ObjectData::isDecodingTexture() const {
+	return this->textureLoader.joinable();
+}
+
+bool ObjectData::isStreamed() const {
+	return this->stream != nullptr;
+}
+
+GLuint ObjectData::getTextureID() const {
+	return this->textureID;
+}
+
+const NormalStats& ObjectData::getNormalStats() const {
+	return this->normalStats;
+}
+
+const RepairStats& ObjectData::getRepairStats() const {
+	return this->repairStats;
+}
+
+const LoadStats& ObjectData::getLoadStats() const {
+	return this->loadStats;
 }
 
-ObjectData& ObjectData::getInstance() {
-	static ObjectData instance;
-	return instance;
+const Diagnostics& ObjectData::getDiagnostics() const {
+	return this->diagnostics;
+}
+
+size_t ObjectData::getVertexCount() const {
+	if (this->store.isOpen())
+		return this->store.array<const SharedMeshInfo>(SHARED_INFO)->sourceVertices;
+	return this->vertices.size();
+}
+
+size_t ObjectData::getTriangleCount() const {
+	return static_cast<size_t>(this->vertexCount) / 3;
+}
+
+Vec3 ObjectData::getMin() const {
+	return Vec3(this->minX, this->minY, this->minZ) + this->center;
+}
+
+Vec3 ObjectData::getMax() const {
+	return Vec3(this->maxX, this->maxY, this->maxZ) + this->center;
 }
 
 ObjectData::~ObjectData() {
+	if (this->loader.joinable()) { // Window closed mid-load
+		this->loadCancelled = true;
+		this->loader.join();
+	}
+	this->cancelBvh(); // Once the loader can no longer queue it
+	if (this->textureLoader.joinable())
+		this->textureLoader.join();
 	if (this->ppmData.data) {
 		delete[] this->ppmData.data;
 		this->ppmData.data = nullptr;
@@ -0,0 +1,46 @@
+#include "Options.hpp"
+
+static size_t parsePositive(const std::string& option, const char* value) {
+	if (value == nullptr)
+		throw InvalidOptionException(option);
+	try {
+		size_t end = 0;
+		const long number = std::stol(value, &end);
+		if (value[end] != '\0' || number <= 0)
+			throw InvalidOptionException(option + " " + value);
+		return static_cast<size_t>(number);
+	}
+	catch (const std::logic_error&) {
+		throw InvalidOptionException(option + " " + value);
+	}
+}
+
+Options parseOptions(const int argc, const char* argv[]) {
+	Options options;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg(argv[i]);
+		if (arg == "--chunk")
+			options.chunk = true;
+		else if (arg == "--batch")
+			options.batch = true;
+		else if (arg == "--strict")
+			options.strict = true;
+		else if (arg == "--quiet")
+			options.quiet = true;
+		else if (arg == "--no-share")
+			options.share = false;
+		else if (arg == "--budget")
+			options.streamBudget = parsePositive(arg, i + 1 < argc ? argv[++i] : nullptr) << 20;
+		else if (arg == "--instances")
+			options.instances = parsePositive(arg, i + 1 < argc ? argv[++i] : nullptr);
+		else if (arg.rfind("--", 0) == 0)
+			throw InvalidOptionException(arg);
+		else
+			options.paths.push_back(arg);
+	}
+	if (options.paths.empty())
+		throw NoArgException();
+	if (!options.batch && options.paths.size() > SCENE_MESH_LIMIT)
+		throw TooManyArgException();
+	return options;
+}
@@ -0,0 +1,119 @@
+#include "RenderState.hpp"
+
+void RenderState::beginFrame() {
+	if (this->instances.getBuffer() == 0) {
+		for (GLuint column = 0; column < 4; ++column)
+			glVertexAttribDivisor(ATTRIB_MODELVIEW + column, 1);
+	}
+	this->instances.beginFrame();
+	this->stats.frames++;
+}
+
+// Program, texture and enabled arrays carry over to the next frame, nothing else draws in between.
+// Meshes are bound again since their buffers may have been replaced meanwhile.
+void RenderState::endFrame() {
+	this->instances.endFrame();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	this->mesh = nullptr;
+}
+
+void RenderState::useProgram(const GLuint program) {
+	if (program == this->program)
+		return;
+	glUseProgram(program);
+	this->program = program;
+	this->stats.programChanges++;
+}
+
+void RenderState::bindTexture(const GLuint texture) {
+	if (texture == this->texture)
+		return;
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	this->texture = texture;
+	this->stats.textureChanges++;
+}
+
+bool RenderState::bindMesh(const void* mesh) {
+	if (mesh == this->mesh)
+		return false;
+	this->mesh = mesh;
+	this->stats.meshChanges++;
+	return true;
+}
+
+void RenderState::enableAttributes(const unsigned int mask) {
+	const unsigned int changed = mask ^ this->attributes;
+	if (changed == 0)
+		return;
+	for (GLuint location = 0; location <= ATTRIB_MODELVIEW; ++location) {
+		if (!(changed & ATTRIB_BIT(location)))
+			continue;
+		const GLuint columns = location == ATTRIB_MODELVIEW ? 4 : 1;
+		for (GLuint column = 0; column < columns; ++column) {
+			if (mask & ATTRIB_BIT(location))
+				glEnableVertexAttribArray(location + column);
+			else
+				glDisableVertexAttribArray(location + column);
+		}
+	}
+	this->attributes = mask;
+	this->stats.attributeChanges++;
+}
+
+void RenderState::setModelView(const Mat4& modelView) {
+	for (GLuint column = 0; column < 4; ++column)
+		glVertexAttrib4fv(ATTRIB_MODELVIEW + column, modelView.data() + column * 4);
+}
+
+void RenderState::setInstances(const Mat4* modelViews, const size_t count) {
+	const size_t bytes = count * sizeof(Mat4);
+	const GLintptr offset = this->instances.upload(modelViews, bytes);
+	for (GLuint column = 0; column < 4; ++column) // Every upload lands somewhere else in the ring
+		glVertexAttribPointer(ATTRIB_MODELVIEW + column, 4, GL_FLOAT, GL_FALSE, sizeof(Mat4),
+			reinterpret_cast<const void*>(offset + column * 4 * sizeof(float)));
+	this->stats.instanceUploads++;
+	this->stats.instanceBytes += bytes;
+}
+
+void RenderState::drawArrays(const GLint first, const GLsizei corners) {
+	glDrawArrays(GL_TRIANGLES, first, corners);
+	this->stats.drawCalls++;
+}
+
+void RenderState::drawArraysInstanced(const GLint first, const GLsizei corners, const GLsizei instances) {
+	glDrawArraysInstanced(GL_TRIANGLES, first, corners, instances);
+	this->stats.drawCalls++;
+	this->stats.instancedDrawCalls++;
+}
+
+void RenderState::multiDrawElements(const GLsizei* counts, const void* const* offsets, const GLsizei draws) {
+	glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_INT, offsets, draws);
+	this->stats.drawCalls++;
+}
+
+void RenderState::drawElementsInstanced(const GLsizei corners, const GLsizei instances) {
+	glDrawElementsInstanced(GL_TRIANGLES, corners, GL_UNSIGNED_INT, nullptr, instances);
+	this->stats.drawCalls++;
+	this->stats.instancedDrawCalls++;
+}
+
+void RenderState::printStats() const {
+	const RenderStats& s = this->stats;
+	if (s.frames == 0)
+		return;
+	const double frames = static_cast<double>(s.frames);
+	std::cout << "Submission: " << BOLD << static_cast<double>(s.drawCalls) / frames << RESET << " draw calls per frame ("
+		<< static_cast<double>(s.instancedDrawCalls) / frames << " instanced), state changes per frame: "
+		<< static_cast<double>(s.programChanges) / frames << " program, " << static_cast<double>(s.textureChanges) / frames << " texture, "
+		<< static_cast<double>(s.meshChanges) / frames << " mesh, " << static_cast<double>(s.attributeChanges) / frames << " attribute, "
+		<< static_cast<double>(s.instanceBytes) / frames / 1024.0 << " KiB of instance matrices in " << static_cast<double>(s.instanceUploads) / frames << " uploads" << std::endl;
+	const DynamicRingStats& ring = this->instances.getStats();
+	std::cout << "Dynamic buffer ring: " << (this->instances.isPersistent() ? "persistently mapped" : "mapped per upload") << ", "
+		<< DYNAMIC_RING_FRAMES << " frames in flight, " << ring.stalls << " stalls, " << ring.grows << " grows" << std::endl;
+}
+
+const RenderStats& RenderState::getStats() const {
+	return this->stats;
+}
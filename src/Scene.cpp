@@ -0,0 +1,252 @@
+#include "Scene.hpp"
+#include "ControlManager.hpp"
+
+Scene& Scene::getInstance() {
+	static Scene instance;
+	return instance;
+}
+
+std::unique_ptr<ObjectData> Scene::openMesh(const std::string& path, const bool progressive) const {
+	auto mesh = std::make_unique<ObjectData>();
+	mesh->setStreamBudget(this->options.streamBudget);
+	mesh->setDiagnosticsMode(this->options.strict, this->options.quiet);
+	mesh->setSharedStore(this->options.share);
+	mesh->loadAsync(path.c_str(), progressive);
+	return mesh;
+}
+
+void Scene::load(const Options& options) {
+	this->options = options;
+	for (const std::string& path : options.paths) {
+		this->meshes.push_back(this->openMesh(path, true));
+		this->watch(path);
+	}
+	this->meshes.front()->decodePPMAsync(TEX_PATH); // One texture for the whole scene
+	this->watch(TEX_PATH);
+	this->reloads.resize(this->meshes.size());
+	this->reloadQueued.resize(this->meshes.size());
+	this->instances.resize(this->meshes.size());
+	this->setInstanceCount(options.instances);
+}
+
+void Scene::upload() {
+	const size_t shaderStage = StartupTimeline::getInstance().begin("Shader compile", {"Window + GL context"});
+	this->shader.build(MESH_VERTEX_SHADER, MESH_FRAGMENT_SHADER,
+		{{ATTRIB_POSITION, "position"}, {ATTRIB_TEXCOORD, "texCoord"}, {ATTRIB_SHADE, "shade"}, {ATTRIB_NORMAL, "normal"},
+		{ATTRIB_MODELVIEW, "modelView"}});
+	StartupTimeline::getInstance().end(shaderStage);
+	for (const auto& mesh : this->meshes)
+		mesh->meshToOpenGL();
+	this->meshes.front()->uploadTexture();
+	for (size_t i = 1; i < this->meshes.size(); ++i)
+		this->meshes[i]->shareTexture(*this->meshes.front());
+}
+
+void Scene::setInstanceCount(const size_t count) {
+	this->instanceCount = std::clamp<size_t>(count, 1, INSTANCE_LIMIT);
+	this->layoutInstances();
+}
+
+// Grid centered on the X axis, rows receding from the camera.
+void Scene::layoutInstances() {
+	this->spacing = this->getMaxDistance() * 2.0f;
+	const size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<float>(this->instanceCount))));
+	for (TransformStore& store : this->instances)
+		store.clear();
+	for (size_t i = 0; i < this->instanceCount; ++i) {
+		const float column = static_cast<float>(i % side) - static_cast<float>(side - 1) / 2.0f;
+		const float row = static_cast<float>(i / side);
+		this->instances[i % this->meshes.size()].add(Vec3(column * this->spacing, 0.0f, -row * this->spacing),
+			Quat::rotateY(static_cast<float>(i) * 0.61f));
+	}
+}
+
+// Hot reload is a convenience, a file it cannot follow still opens.
+void Scene::watch(const std::string& path) {
+	try {
+		this->watcher.watch(path);
+	}
+	catch (const std::exception& e) {
+		std::cout << YELLOW << "WARNING: " << path << " will not reload when saved. " << e.what() << RESET << std::endl;
+		errorCode = NO_ERROR;
+	}
+}
+
+// Not progressive, the old version stays on screen until the new one is complete.
+void Scene::startReload(const size_t index) {
+	if (this->reloads[index]) {
+		this->reloadQueued[index] = true; // The loader may have read the file before this save
+		return;
+	}
+	this->reloadQueued[index] = false;
+	try {
+		this->reloads[index] = this->openMesh(this->options.paths[index], false);
+	}
+	catch (const std::exception& e) { // A .smc loads right away
+		std::cout << YELLOW << "WARNING: Keeping the previous version. " << e.what() << RESET << std::endl;
+		errorCode = NO_ERROR;
+	}
+}
+
+void Scene::pollReloads() {
+	for (const std::string& path : this->watcher.poll()) {
+		if (path == TEX_PATH)
+			this->meshes.front()->reloadTexture();
+		for (size_t i = 0; i < this->meshes.size(); ++i) {
+			if (this->options.paths[i] == path)
+				this->startReload(i);
+		}
+	}
+	for (size_t i = 0; i < this->meshes.size(); ++i) {
+		std::unique_ptr<ObjectData>& reload = this->reloads[i];
+		if (!reload || !reload->isLoaded() || this->meshes[i]->isDecodingTexture())
+			continue; // The decoder writes into the mesh that owns the texture
+		try {
+			reload->finishReload(*this->meshes[i]);
+			this->meshes[i] = std::move(reload);
+		}
+		catch (const std::exception& e) { // A half saved file, the next save brings it back
+			std::cout << YELLOW << "WARNING: Keeping the previous version of " << this->meshes[i]->getFilename() << ". "
+				<< e.what() << RESET << std::endl;
+			errorCode = NO_ERROR;
+		}
+		reload.reset();
+		if (this->reloadQueued[i])
+			this->startReload(i);
+	}
+}
+
+// Previews grow while their file loads, the grid follows until every mesh has its final bounds.
+void Scene::update(const Affine& view, const float rotationAngle) {
+	this->pollReloads();
+	for (const auto& mesh : this->meshes)
+		mesh->update();
+	if (this->getMaxDistance() * 2.0f != this->spacing)
+		this->layoutInstances();
+	const Affine model = Affine::fromTRS(this->position, Quat::rotateY(rotationAngle));
+	for (TransformStore& store : this->instances)
+		store.update(view * model); // Instances turn with the object like a turntable
+}
+
+DrawPipeline Scene::pipelineOf(const ObjectData& mesh) const {
+	if (!mesh.isReady())
+		return PIPELINE_PREVIEW;
+	return mesh.isStreamed() ? PIPELINE_STREAMED : PIPELINE_RESIDENT;
+}
+
+void Scene::draw(const Mat4& projection) {
+	this->drawOrder.clear();
+	for (size_t i = 0; i < this->meshes.size(); ++i) {
+		if (this->instances[i].size() > 0)
+			this->drawOrder.push_back(i);
+	}
+	std::sort(this->drawOrder.begin(), this->drawOrder.end(), [this](const size_t a, const size_t b) {
+		return std::make_tuple(this->pipelineOf(*this->meshes[a]), this->meshes[a]->getTextureID(), a)
+			< std::make_tuple(this->pipelineOf(*this->meshes[b]), this->meshes[b]->getTextureID(), b);
+	});
+	this->state.beginFrame();
+	this->state.useProgram(this->shader.getProgram());
+	glUniform1i(this->shader.uniform("tex"), 0);
+	for (const size_t i : this->drawOrder) {
+		const TransformStore& store = this->instances[i];
+		this->meshes[i]->draw(this->state, this->shader, projection, store.getModelViews().data(), store.size());
+	}
+	this->state.endFrame();
+}
+
+void Scene::moveObject(const int control, const float speed) {
+	const float ajustedSpeed = (speed * this->getMaxDistance()) * FrameTimer::getInstance().getDeltaTime();
+	switch (control) {
+		case RESET_POSITION:
+			this->position = Vec3(0.0f, 0.0f, 0.0f);
+			break;
+		case UP:
+			this->position.y += ajustedSpeed;
+			break;
+		case DOWN:
+			this->position.y -= ajustedSpeed;
+			break;
+		case LEFT:
+			this->position.x -= ajustedSpeed;
+			break;
+		case RIGHT:
+			this->position.x += ajustedSpeed;
+			break;
+		case FORWARD:
+			this->position.z -= ajustedSpeed;
+			break;
+		case BACKWARD:
+			this->position.z += ajustedSpeed;
+			break;
+		default:
+			break;
+	}
+}
+
+void Scene::toggleTexture() {
+	for (const auto& mesh : this->meshes)
+		mesh->toggleTexture();
+}
+
+void Scene::cycleProjection() {
+	for (const auto& mesh : this->meshes)
+		mesh->cycleProjection();
+}
+
+void Scene::toggleCulling() {
+	for (const auto& mesh : this->meshes)
+		mesh->toggleCulling();
+}
+
+void Scene::toggleLighting() {
+	for (const auto& mesh : this->meshes)
+		mesh->toggleLighting();
+}
+
+void Scene::printRenderStats() const {
+	for (size_t i = 0; i < this->meshes.size(); ++i) {
+		if (this->meshes.size() > 1)
+			std::cout << BOLD << this->meshes[i]->getFilename() << ":" << RESET << std::endl;
+		this->instances[i].printStats();
+		this->meshes[i]->printRenderStats();
+	}
+	this->state.printStats();
+}
+
+// Hits keep their distance from one mesh to the next, so the closest one over the scene wins.
+bool Scene::pick(const Vec3& origin, const Vec3& direction, RayHit& hit, size_t& mesh, size_t& instance) const {
+	bool found = false;
+	for (size_t i = 0; i < this->meshes.size(); ++i) {
+		const TransformStore& store = this->instances[i];
+		size_t local = 0;
+		if (this->meshes[i]->pick(store.getModelViews().data(), store.size(), origin, direction, hit, local)) {
+			mesh = i;
+			instance = local * this->meshes.size() + i; // Back to the grid numbering
+			found = true;
+		}
+	}
+	return found;
+}
+
+size_t Scene::getInstanceCount() const {
+	return this->instanceCount;
+}
+
+size_t Scene::getMeshCount() const {
+	return this->meshes.size();
+}
+
+const ObjectData& Scene::getMesh(const size_t index) const {
+	return *this->meshes[index];
+}
+
+float Scene::getMaxDistance() const {
+	float distance = 0.0f;
+	for (const auto& mesh : this->meshes)
+		distance = std::max(distance, mesh->getMaxDistance());
+	return distance;
+}
+
+bool Scene::isReady() const {
+	return std::all_of(this->meshes.begin(), this->meshes.end(), [](const auto& mesh) { return mesh->isReady(); });
+}
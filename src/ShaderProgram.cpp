@@ -0,0 +1,71 @@
+#include "ShaderProgram.hpp"
+
+GLuint ShaderProgram::compile(const GLenum type, const char* source) {
+	const GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, nullptr);
+	glCompileShader(shader);
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE) {
+		GLint length = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+		std::string log(std::max(length, 1), '\0');
+		glGetShaderInfoLog(shader, length, nullptr, log.data());
+		glDeleteShader(shader);
+		throw RuntimeException("ERROR: Shader compilation failed\n" + log);
+	}
+	return shader;
+}
+
+void ShaderProgram::build(const char* vertexSource, const char* fragmentSource,
+	const std::vector<std::pair<GLuint, const char*>>& attributes) {
+	const GLuint vertexShader = compile(GL_VERTEX_SHADER, vertexSource);
+	GLuint fragmentShader;
+	try {
+		fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentSource);
+	}
+	catch (const RuntimeException&) {
+		glDeleteShader(vertexShader);
+		throw;
+	}
+	this->program = glCreateProgram();
+	glAttachShader(this->program, vertexShader);
+	glAttachShader(this->program, fragmentShader);
+	for (const auto& [location, name] : attributes)
+		glBindAttribLocation(this->program, location, name); // Fixed locations so buffers can be set up without a lookup
+	glLinkProgram(this->program);
+	glDeleteShader(vertexShader); // Flagged for deletion, freed with the program
+	glDeleteShader(fragmentShader);
+	GLint status = GL_FALSE;
+	glGetProgramiv(this->program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE) {
+		GLint length = 0;
+		glGetProgramiv(this->program, GL_INFO_LOG_LENGTH, &length);
+		std::string log(std::max(length, 1), '\0');
+		glGetProgramInfoLog(this->program, length, nullptr, log.data());
+		glDeleteProgram(this->program);
+		this->program = 0;
+		throw RuntimeException("ERROR: Shader link failed\n" + log);
+	}
+}
+
+void ShaderProgram::use() const {
+	glUseProgram(this->program);
+}
+
+GLint ShaderProgram::uniform(const char* name) const {
+	return glGetUniformLocation(this->program, name);
+}
+
+GLuint ShaderProgram::getProgram() const {
+	return this->program;
+}
+
+bool ShaderProgram::isBuilt() const {
+	return this->program != 0;
+}
+
+ShaderProgram::~ShaderProgram() {
+	if (this->program)
+		glDeleteProgram(this->program);
+}
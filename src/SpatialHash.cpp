@@ -0,0 +1,37 @@
+#include "SpatialHash.hpp"
+
+bool SpatialHash::Cell::operator==(const Cell& other) const {
+	return this->x == other.x && this->y == other.y && this->z == other.z;
+}
+
+SpatialHash::SpatialHash(const std::vector<Vec3>& points, const Vec3& origin, const float radius)
+	: points(points), origin(origin), toCell(1.0f / (radius * SPATIAL_HASH_CELL_RADII)) {
+	const size_t count = points.size();
+	size_t buckets = 1;
+	while (buckets < count)
+		buckets <<= 1;
+	this->mask = buckets - 1;
+	this->cells.resize(count);
+	std::vector<uint32_t> bucketOfPoint(count);
+	parallelFor(count, SPATIAL_HASH_MIN_CHUNK, [&](const size_t begin, const size_t end, size_t) {
+		for (size_t i = begin; i < end; ++i) {
+			const Vec3 p = (points[i] - origin) * this->toCell;
+			this->cells[i] = {static_cast<int32_t>(std::floor(p.x)), static_cast<int32_t>(std::floor(p.y)), static_cast<int32_t>(std::floor(p.z))};
+			bucketOfPoint[i] = static_cast<uint32_t>(this->bucketOf(this->cells[i]));
+		}
+	});
+	this->bucketStart.assign(buckets + 1, 0);
+	for (const uint32_t bucket : bucketOfPoint)
+		this->bucketStart[bucket + 1]++;
+	for (size_t b = 0; b < buckets; ++b)
+		this->bucketStart[b + 1] += this->bucketStart[b];
+	std::vector<uint32_t> fill(this->bucketStart.begin(), this->bucketStart.end() - 1);
+	this->items.resize(count);
+	for (size_t i = 0; i < count; ++i) // Ascending, so every bucket lists its points in index order
+		this->items[fill[bucketOfPoint[i]]++] = static_cast<uint32_t>(i);
+}
+
+size_t SpatialHash::bucketOf(const Cell& cell) const {
+	const auto x = static_cast<uint32_t>(cell.x), y = static_cast<uint32_t>(cell.y), z = static_cast<uint32_t>(cell.z);
+	return ((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u)) & this->mask;
+}
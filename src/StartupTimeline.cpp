@@ -0,0 +1,99 @@
+#include "StartupTimeline.hpp"
+
+StartupTimeline& StartupTimeline::getInstance() {
+	static StartupTimeline instance;
+	return instance;
+}
+
+double StartupTimeline::now() const {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->origin).count();
+}
+
+size_t StartupTimeline::begin(const std::string& stage, const std::initializer_list<const char*> dependencies,
+	const std::string& scope) {
+	const std::lock_guard<std::mutex> lock(this->mutex);
+	if (this->stopped)
+		return TIMELINE_SKIPPED;
+	this->stages.push_back({stage, scope, std::vector<std::string>(dependencies.begin(), dependencies.end()), this->now()});
+	return this->stages.size() - 1;
+}
+
+void StartupTimeline::end(const size_t stage) {
+	const std::lock_guard<std::mutex> lock(this->mutex);
+	if (stage < this->stages.size())
+		this->stages[stage].end = this->now();
+}
+
+void StartupTimeline::stop() {
+	const std::lock_guard<std::mutex> lock(this->mutex);
+	this->stopped = true;
+}
+
+// The last finished stage of that name in the scope, or without a scope when the scope has none.
+const StartupTimeline::Stage* StartupTimeline::find(const std::string& stage, const std::string& scope) const {
+	const Stage* shared = nullptr;
+	for (auto it = this->stages.rbegin(); it != this->stages.rend(); ++it) {
+		if (it->name != stage || it->end < 0.0)
+			continue;
+		if (it->scope == scope)
+			return &*it;
+		if (it->scope.empty() && !shared)
+			shared = &*it;
+	}
+	return shared;
+}
+
+static std::string labelOf(const std::string& name, const std::string& scope) {
+	return scope.empty() ? name : name + " (" + scope + ")";
+}
+
+void StartupTimeline::print() {
+	const std::lock_guard<std::mutex> lock(this->mutex);
+	if (this->stopped || this->stages.empty())
+		return;
+	this->stopped = true;
+	const Stage* last = nullptr;
+	double busy = 0.0;
+	for (const Stage& s : this->stages) {
+		if (s.end < 0.0)
+			continue;
+		busy += s.end - s.start;
+		if (!last || s.end > last->end)
+			last = &s;
+	}
+	if (!last)
+		return;
+	const double scale = TIMELINE_WIDTH / std::max(last->end, 1e-3);
+	const std::ios_base::fmtflags flags = std::cout.flags();
+	const std::streamsize precision = std::cout.precision();
+	std::cout << BOLD << "Startup timeline:" << RESET << std::endl;
+	for (const Stage& s : this->stages) {
+		if (s.end < 0.0)
+			continue;
+		const auto offset = static_cast<size_t>(s.start * scale);
+		const size_t length = std::max<size_t>(static_cast<size_t>((s.end - s.start) * scale), 1);
+		std::cout << "  " << std::left << std::setw(TIMELINE_LABEL) << labelOf(s.name, s.scope) << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(8) << s.start << " -> " << std::setw(8) << s.end << " ms  "
+			<< std::string(offset, ' ') << std::string(length, '#') << std::endl;
+	}
+
+	std::vector<const Stage*> path{last};
+	while (true) { // Walk back through the dependency that finished last
+		const Stage* next = nullptr;
+		for (const std::string& dependency : path.back()->dependencies) {
+			const Stage* candidate = this->find(dependency, path.back()->scope);
+			if (candidate && (!next || candidate->end > next->end))
+				next = candidate;
+		}
+		if (!next)
+			break;
+		path.push_back(next);
+	}
+	std::cout << "  Critical path: ";
+	for (auto it = path.rbegin(); it != path.rend(); ++it)
+		std::cout << (it == path.rbegin() ? "" : " -> ") << labelOf((*it)->name, (*it)->scope);
+	std::cout << " (" << BOLD << last->end << " ms" << RESET << " wall for " << busy << " ms of stage work)"
+		<< std::endl << std::endl;
+	std::cout.flags(flags);
+	std::cout.precision(precision);
+}
@@ -0,0 +1,124 @@
+#include "StreamedMesh.hpp"
+
+StreamedMesh::StreamedMesh(const std::string& path, const size_t budget) : budget(budget) {
+	this->file.openReadOnly(path);
+	if (this->file.size() < sizeof(ChunkFileHeader))
+		throw RuntimeException("ERROR: \"" + path + "\" is too small to be a chunked mesh.");
+	std::memcpy(&this->header, this->file.data(), sizeof(ChunkFileHeader));
+	if (std::memcmp(this->header.magic, CHUNK_MAGIC, sizeof(this->header.magic)) != 0)
+		throw RuntimeException("ERROR: \"" + path + "\" is not a chunked mesh, rebuild it with --chunk.");
+	this->clusters = reinterpret_cast<const ChunkCluster*>(this->file.data() + sizeof(ChunkFileHeader));
+	if (this->header.clusterCount > (this->file.size() - sizeof(ChunkFileHeader)) / sizeof(ChunkCluster)) // Sums of header fields could wrap
+		throw RuntimeException("ERROR: \"" + path + "\" is truncated.");
+	for (size_t i = 0; i < this->header.clusterCount; ++i) {
+		const ChunkCluster& cluster = this->clusters[i];
+		if (cluster.offset > this->file.size() || chunkBlockSize(cluster.triangleCount) > this->file.size() - cluster.offset)
+			throw RuntimeException("ERROR: \"" + path + "\" is truncated.");
+	}
+	this->residency.resize(this->header.clusterCount);
+}
+
+size_t StreamedMesh::gpuBytes(const ChunkCluster& cluster) {
+	return static_cast<size_t>(cluster.triangleCount) * 3 * (sizeof(PackedVertex) + sizeof(PackedTexCoord));
+}
+
+void StreamedMesh::update(const Vec3& eye, const bool cullBackFacing) {
+	this->frame++;
+	this->wanted.clear();
+	this->drawn.clear();
+	std::vector<float> distance(this->header.clusterCount);
+	for (size_t i = 0; i < this->header.clusterCount; ++i) {
+		const ClusterBounds& bounds = this->clusters[i].bounds;
+		if (cullBackFacing && isBackFacing(bounds, eye))
+			continue;
+		distance[i] = (bounds.center - eye).length() - bounds.radius;
+		this->wanted.push_back(i);
+	}
+	this->culled = this->header.clusterCount - this->wanted.size();
+	std::sort(this->wanted.begin(), this->wanted.end(), [&](const size_t a, const size_t b) { return distance[a] < distance[b]; });
+
+	size_t uploaded = 0;
+	size_t prefetched = 0;
+	for (const size_t cluster : this->wanted) {
+		Residency& resident = this->residency[cluster];
+		if (resident.buffer == 0) {
+			if (uploaded == STREAM_UPLOADS_PER_FRAME) {
+				if (prefetched++ < STREAM_PREFETCH) // Page in what the next frames will upload
+					this->file.prefetch(this->clusters[cluster].offset, chunkBlockSize(this->clusters[cluster].triangleCount));
+				continue;
+			}
+			if (!this->makeRoom(gpuBytes(this->clusters[cluster])))
+				break; // Budget is full of nearer clusters
+			this->upload(cluster);
+			uploaded++;
+		}
+		resident.lastUsed = this->frame;
+		this->drawn.push_back(cluster);
+	}
+}
+
+// Evicts clusters not wanted this frame, least recently used first.
+bool StreamedMesh::makeRoom(const size_t bytes) {
+	while (this->residentBytes + bytes > this->budget) {
+		size_t victim = this->residency.size();
+		for (size_t i = 0; i < this->residency.size(); ++i) {
+			const Residency& resident = this->residency[i];
+			if (resident.buffer != 0 && resident.lastUsed < this->frame
+				&& (victim == this->residency.size() || resident.lastUsed < this->residency[victim].lastUsed))
+				victim = i;
+		}
+		if (victim == this->residency.size())
+			return false;
+		this->evict(victim);
+	}
+	return true;
+}
+
+void StreamedMesh::upload(const size_t cluster) {
+	const ChunkCluster& c = this->clusters[cluster];
+	Residency& resident = this->residency[cluster];
+	glGenBuffers(1, &resident.buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, resident.buffer);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(gpuBytes(c)), this->file.data() + c.offset, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	this->file.release(c.offset, chunkBlockSize(c.triangleCount)); // The GPU holds the only copy now
+	this->residentBytes += gpuBytes(c);
+	this->peakResidentBytes = std::max(this->peakResidentBytes, this->residentBytes);
+	this->uploads++;
+}
+
+void StreamedMesh::evict(const size_t cluster) {
+	Residency& resident = this->residency[cluster];
+	glDeleteBuffers(1, &resident.buffer);
+	resident.buffer = 0;
+	this->residentBytes -= gpuBytes(this->clusters[cluster]);
+	this->evictions++;
+}
+
+// Attribute arrays are enabled by the caller, only the pointers change per cluster.
+void StreamedMesh::draw(RenderState& state, const size_t instances) const {
+	for (const size_t cluster : this->drawn) {
+		const GLsizei corners = static_cast<GLsizei>(this->clusters[cluster].triangleCount) * 3;
+		glBindBuffer(GL_ARRAY_BUFFER, this->residency[cluster].buffer);
+		glVertexAttribPointer(ATTRIB_POSITION, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex),
+			reinterpret_cast<const void*>(offsetof(PackedVertex, position)));
+		glVertexAttribPointer(ATTRIB_SHADE, 1, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedVertex),
+			reinterpret_cast<const void*>(offsetof(PackedVertex, shade)));
+		glVertexAttribPointer(ATTRIB_TEXCOORD, 2, GL_SHORT, GL_TRUE, sizeof(PackedTexCoord),
+			reinterpret_cast<const void*>(corners * sizeof(PackedVertex)));
+		state.drawArraysInstanced(0, corners, static_cast<GLsizei>(instances));
+	}
+}
+
+void StreamedMesh::printStats() const {
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	std::cout << "Streaming: " << this->uploads << " uploads, " << this->evictions << " evictions, resident peak "
+		<< this->peakResidentBytes / (1024 * 1024) << " MB of " << this->budget / (1024 * 1024) << " MB budget, "
+		<< this->culled << " back-facing clusters skipped last frame, process peak "
+		<< usage.ru_maxrss / 1024 << " MB" << std::endl;
+}
+
+const ChunkFileHeader& StreamedMesh::getHeader() const {
+	return this->header;
+}
@@ -0,0 +1,163 @@
+#include "TransformStore.hpp"
+#include <cstring>
+
+size_t TransformStore::add(const Vec3& position, const Quat& rotation, const float scale) {
+	if (this->count % TRANSFORM_BATCH == 0)
+		this->grow(); // Arrays always hold whole blocks so the kernel never needs a scalar tail
+	const size_t index = this->count++;
+	this->setPosition(index, position);
+	this->setRotation(index, rotation);
+	this->setScale(index, scale);
+	return index;
+}
+
+void TransformStore::grow() {
+	const size_t size = this->count + TRANSFORM_BATCH;
+	this->posX.resize(size, 0.0f);
+	this->posY.resize(size, 0.0f);
+	this->posZ.resize(size, 0.0f);
+	this->rotX.resize(size, 0.0f);
+	this->rotY.resize(size, 0.0f);
+	this->rotZ.resize(size, 0.0f);
+	this->rotW.resize(size, 1.0f);
+	this->scale.resize(size, 0.0f); // Padding lanes collapse to a zero matrix
+	for (auto& component : this->model)
+		component.resize(size, 0.0f);
+	this->dirty.resize(size, 0);
+	this->modelViews.resize(size, Mat4::identity());
+}
+
+void TransformStore::clear() {
+	this->count = 0;
+	this->posX.clear();
+	this->posY.clear();
+	this->posZ.clear();
+	this->rotX.clear();
+	this->rotY.clear();
+	this->rotZ.clear();
+	this->rotW.clear();
+	this->scale.clear();
+	for (auto& component : this->model)
+		component.clear();
+	this->dirty.clear();
+	this->modelViews.clear();
+	this->sharedValid = false;
+}
+
+void TransformStore::setPosition(const size_t index, const Vec3& position) {
+	this->posX[index] = position.x;
+	this->posY[index] = position.y;
+	this->posZ[index] = position.z;
+	this->dirty[index] = 1;
+}
+
+void TransformStore::setRotation(const size_t index, const Quat& rotation) {
+	this->rotX[index] = rotation.x;
+	this->rotY[index] = rotation.y;
+	this->rotZ[index] = rotation.z;
+	this->rotW[index] = rotation.w;
+	this->dirty[index] = 1;
+}
+
+void TransformStore::setScale(const size_t index, const float scale) {
+	this->scale[index] = scale;
+	this->dirty[index] = 1;
+}
+
+// Same math as Affine::fromTRS, laid out lane by lane over the structure of arrays.
+void TransformStore::updateModelBlock(const size_t base) {
+	const float* __restrict__ qx = &this->rotX[base];
+	const float* __restrict__ qy = &this->rotY[base];
+	const float* __restrict__ qz = &this->rotZ[base];
+	const float* __restrict__ qw = &this->rotW[base];
+	const float* __restrict__ s = &this->scale[base];
+	float* __restrict__ m[12];
+	for (int c = 0; c < 12; ++c)
+		m[c] = &this->model[c][base];
+
+	for (int l = 0; l < TRANSFORM_BATCH; ++l) {
+		const float xx = qx[l] * qx[l], yy = qy[l] * qy[l], zz = qz[l] * qz[l];
+		const float xy = qx[l] * qy[l], xz = qx[l] * qz[l], yz = qy[l] * qz[l];
+		const float wx = qw[l] * qx[l], wy = qw[l] * qy[l], wz = qw[l] * qz[l];
+		m[0][l] = (1.0f - 2.0f * (yy + zz)) * s[l];
+		m[1][l] = 2.0f * (xy + wz) * s[l];
+		m[2][l] = 2.0f * (xz - wy) * s[l];
+		m[3][l] = 2.0f * (xy - wz) * s[l];
+		m[4][l] = (1.0f - 2.0f * (xx + zz)) * s[l];
+		m[5][l] = 2.0f * (yz + wx) * s[l];
+		m[6][l] = 2.0f * (xz + wy) * s[l];
+		m[7][l] = 2.0f * (yz - wx) * s[l];
+		m[8][l] = (1.0f - 2.0f * (xx + yy)) * s[l];
+	}
+	std::memcpy(m[9], &this->posX[base], TRANSFORM_BATCH * sizeof(float));
+	std::memcpy(m[10], &this->posY[base], TRANSFORM_BATCH * sizeof(float));
+	std::memcpy(m[11], &this->posZ[base], TRANSFORM_BATCH * sizeof(float));
+	std::memset(&this->dirty[base], 0, TRANSFORM_BATCH);
+}
+
+void TransformStore::composeBlock(const size_t base, const Affine& shared) {
+	const float a[12] = {
+		shared.col[0].x, shared.col[0].y, shared.col[0].z,
+		shared.col[1].x, shared.col[1].y, shared.col[1].z,
+		shared.col[2].x, shared.col[2].y, shared.col[2].z,
+		shared.t.x, shared.t.y, shared.t.z};
+	float out[16][TRANSFORM_BATCH];
+
+	for (int c = 0; c < 4; ++c) { // Output column c = shared.linear * model.col[c] (+ shared.t for the translation)
+		const float* __restrict__ mx = &this->model[c * 3][base];
+		const float* __restrict__ my = &this->model[c * 3 + 1][base];
+		const float* __restrict__ mz = &this->model[c * 3 + 2][base];
+		const float w = c == 3 ? 1.0f : 0.0f;
+		for (int row = 0; row < 3; ++row) {
+			for (int l = 0; l < TRANSFORM_BATCH; ++l)
+				out[c * 4 + row][l] = a[row] * mx[l] + a[3 + row] * my[l] + a[6 + row] * mz[l] + a[9 + row] * w;
+		}
+		for (int l = 0; l < TRANSFORM_BATCH; ++l)
+			out[c * 4 + 3][l] = w;
+	}
+	for (int l = 0; l < TRANSFORM_BATCH; ++l) {
+		float m[16];
+		for (int i = 0; i < 16; ++i)
+			m[i] = out[i][l];
+		this->modelViews[base + l] = Mat4(m);
+	}
+}
+
+void TransformStore::update(const Affine& shared) {
+	const auto start = std::chrono::high_resolution_clock::now();
+	const bool sharedChanged = !this->sharedValid || std::memcmp(&shared, &this->lastShared, sizeof(Affine)) != 0;
+
+	for (size_t base = 0; base < this->count; base += TRANSFORM_BATCH) {
+		bool blockDirty = false;
+		for (size_t l = 0; l < TRANSFORM_BATCH; ++l)
+			blockDirty |= this->dirty[base + l] != 0;
+		if (blockDirty)
+			this->updateModelBlock(base);
+		if (!blockDirty && !sharedChanged) {
+			this->blocksSkipped++;
+			continue;
+		}
+		this->composeBlock(base, shared);
+		this->matricesComputed += std::min<size_t>(TRANSFORM_BATCH, this->count - base);
+	}
+	this->lastShared = shared;
+	this->sharedValid = true;
+	this->kernelSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void TransformStore::printStats() const {
+	if (this->matricesComputed == 0)
+		return;
+	std::cout << "Transform kernel: " << this->matricesComputed << " matrices in "
+		<< this->kernelSeconds * 1000.0 << " ms (" << BOLD
+		<< static_cast<double>(this->matricesComputed) / this->kernelSeconds / 1e6 << " M matrices/s" << RESET
+		<< "), " << this->blocksSkipped << " clean blocks skipped" << std::endl;
+}
+
+size_t TransformStore::size() const {
+	return this->count;
+}
+
+const std::vector<Mat4>& TransformStore::getModelViews() const {
+	return this->modelViews;
+}
@@ -1,4 +1,8 @@
 #include "WindowManager.hpp"
+#include "ControlManager.hpp"
+
+static constexpr Vec3 WORLD_ORIGIN(0.0f, 0.0f, 0.0f);
+static constexpr Vec3 WORLD_UP(0.0f, 1.0f, 0.0f);
 
 static bool validateResolution(const std::vector<int>& windowRes, const std::vector<int>& maxRes) {
 	if (windowRes.size() != 2)
@@ -11,14 +15,14 @@ static bool validateResolution(const std::vector<int>& windowRes, const std::vec
 }
 
 Vec3 WindowManager::computeEye() {
-	return ObjectData::getInstance().getCenter() + Vec3(0.0f, 0.0f, ObjectData::getInstance().getMaxDistance() * 1.5f);
+	return Scene::getInstance().getMesh(0).getCenter() + Vec3(0.0f, 0.0f, Scene::getInstance().getMaxDistance() * 1.5f);
 }
 
 void WindowManager::resolveName(const char *name) {
 	if (name)
 		this->name = name;
 	else
-		this->name = "SCOP - " + ObjectData::getInstance().getFilename();
+		this->name = "SCOP - " + Scene::getInstance().getMesh(0).getFilename();
 }
 
 void WindowManager::resolveResolution(const std::vector<int>& windowRes) {
@@ -50,7 +54,7 @@ void WindowManager::createWindow(const char *name, const std::vector<int>& windo
 	this->colormap = XCreateColormap(this->display, root, this->visualInfo->visual, AllocNone); // Create a colormap for the visual
 	XSetWindowAttributes attributes;
 	attributes.colormap = this->colormap;
-	attributes.event_mask = ExposureMask | KeyPressMask | KeyReleaseMask | StructureNotifyMask; // Set the event mask for the window
+	attributes.event_mask = ExposureMask | KeyPressMask | KeyReleaseMask | ButtonPressMask | StructureNotifyMask; // Set the event mask for the window
 	
 	this->window = XCreateWindow(this->display, root, 0, 0, this->resolution[0], this->resolution[1], 0,
 			this->visualInfo->depth, InputOutput, this->visualInfo->visual, CWColormap | CWEventMask, &attributes); // Create the window
@@ -80,9 +84,14 @@ void WindowManager::updateProjectionMatrix() {
 
 void WindowManager::loop() {
 	XEvent event;
+	bool controlsShown = false;
 	this->running = true;
-	ControlManager::getInstance().printInfo();
 	while (this->running) {
+		if (!controlsShown && Scene::getInstance().isReady()) { // The loader thread owns the terminal until then
+			StartupTimeline::getInstance().print();
+			ControlManager::getInstance().printInfo();
+			controlsShown = true;
+		}
 		while (XPending(this->display)) {
 			XNextEvent(this->display, &event);
 			switch (event.type) {
@@ -100,6 +109,10 @@ void WindowManager::loop() {
 					}
 					ControlManager::getInstance().handleKeyRelease(XLookupKeysym(&event.xkey, 0));
 					break;
+				case ButtonPress:
+					if (event.xbutton.button == Button1)
+						this->pick(event.xbutton.x, event.xbutton.y);
+					break;
 				case ClientMessage:
 					if (event.xclient.data.l[0] == this->wmDelete) {
 						this->running = false;
@@ -126,12 +139,42 @@ void WindowManager::loop() {
 		ControlManager::getInstance().checkActiveControls();
 		this->render();
 	}
+	this->capture.finish();
+	std::cout << std::endl;
+	Scene::getInstance().printRenderStats();
 }
 
 void WindowManager::exitProgram() {
 	this->running = false;
 }
 
+void WindowManager::takeScreenshot() {
+	this->capture.screenshot();
+}
+
+void WindowManager::toggleRecording() {
+	this->capture.toggleRecording();
+}
+
+// Casts a ray through the clicked pixel, the projection gives the view space direction.
+void WindowManager::pick(const int x, const int y) {
+	const float* p = this->projectionMatrix.data();
+	const float ndcX = 2.0f * (static_cast<float>(x) + 0.5f) / static_cast<float>(this->resolution[0]) - 1.0f;
+	const float ndcY = 1.0f - 2.0f * (static_cast<float>(y) + 0.5f) / static_cast<float>(this->resolution[1]);
+	RayHit hit;
+	size_t mesh = 0, instance = 0;
+	const auto start = std::chrono::steady_clock::now();
+	const bool found = Scene::getInstance().pick(Vec3(), Vec3(ndcX / p[0], ndcY / p[5], -1.0f), hit, mesh, instance);
+	const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	clearTerminalLines(); // Status line under the controls, rewritten on every click
+	if (found)
+		std::cout << "Picked triangle " << hit.triangle << " of " << Scene::getInstance().getMesh(mesh).getFilename()
+			<< " instance " << instance << " at distance " << hit.distance;
+	else
+		std::cout << "Nothing under the cursor";
+	std::cout << " (" << us << " us)" << std::flush;
+}
+
 void WindowManager::render() {
 	FrameTimer::getInstance().update();
 	
@@ -140,13 +183,11 @@ void WindowManager::render() {
 	glClearColor(0.6f, 0.6f, 0.6f, 1.0f);
 
 	glMatrixMode(GL_MODELVIEW);
-	this->viewMatrix = Mat4::lookAt(this->computeEye(), Vec3(0.0f, 0.0f, 0.0f),
-		Vec3(0.0f, 1.0f, 0.0f));
+	this->viewMatrix = Affine::lookAt(this->computeEye(), WORLD_ORIGIN, WORLD_UP);
 	this->rotationAngle += 1.00f * FrameTimer::getInstance().getDeltaTime(); // Increment rotation angle based on delta time
-	this->modelMatrix = Mat4::translate(ObjectData::getInstance().getPosition()) * Mat4::rotateY(this->rotationAngle);
-	glLoadIdentity();
-	glLoadMatrixf((this->viewMatrix * this->modelMatrix).data()); // Load the combined projection and view matrix
-	ObjectData::getInstance().draw();
+	Scene::getInstance().update(this->viewMatrix, this->rotationAngle);
+	Scene::getInstance().draw(this->projectionMatrix);
+	this->capture.capture(this->resolution[0], this->resolution[1]);
 	glXSwapBuffers(this->display, this->window); // Swap buffers to display the rendered frame
 }
 
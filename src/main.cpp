@@ -1,26 +1,39 @@
 #include <iostream>
 #include "exceptionTypes.hpp"
-#include "ObjectData.hpp"
+#include "Scene.hpp"
 #include "WindowManager.hpp"
+#include "MeshChunker.hpp"
+#include "BatchRunner.hpp"
+#include "Options.hpp"
+#include "StartupTimeline.hpp"
 
-errorType errorCode = NO_ERROR;
+std::atomic<errorType> errorCode = NO_ERROR;
 
 int main(const int argc, const char *argv[])
 {
+	StartupTimeline::getInstance(); // Timeline origin
+	JobSystem::getInstance(); // Built before the scene so it outlives the loader threads
 	try {
-		if (argc != 2) {
-			if (argc == 1)
-				throw NoArgException();
-			throw TooManyArgException();
+		const Options options = parseOptions(argc, argv);
+		if (options.chunk) {
+			for (const std::string& path : options.paths)
+				MeshChunker::build(path);
+			return errorCode;
 		}
-		ObjectData::getInstance().load(argv[1]);
+		if (options.batch) {
+			BatchRunner::run(options);
+			return errorCode;
+		}
+		Scene::getInstance().load(options); // OBJ parsing, PPM decoding and the X/GLX setup overlap
+		const size_t windowStage = StartupTimeline::getInstance().begin("Window + GL context");
 		WindowManager::getInstance().createWindow();
-		ObjectData::getInstance().loadPPM(TEX_PATH);
+		StartupTimeline::getInstance().end(windowStage);
+		Scene::getInstance().upload();
 		WindowManager::getInstance().loop();
 	}
 	catch (const std::exception& e) {
 		std::cerr << RED << e.what() << RESET << std::endl;
-		errorCode = errorCode == NO_ERROR ? UNDEFINED_ERROR : errorCode;
+		errorCode = errorCode == NO_ERROR ? UNDEFINED_ERROR : errorCode.load();
 	}
 	return errorCode;
 }
\ No newline at end of file